@@ -0,0 +1,363 @@
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <optional>
+#include <random>
+#include <string>
+#include <vector>
+#include "MpAccumulator.h"
+#include "MpCombinatorics.h"
+#include "MpConstants.h"
+#include "MpDecimal.h"
+#include "MpInt.h"
+#include "MpPrime.h"
+#include "MpProduct.h"
+#include "MpRandom.h"
+#include "MpRns.h"
+
+/** Default time limit of one measured operation in seconds */
+constexpr double BENCHMARK_BUDGET_SECONDS = 2.0;
+/** Minimal measured time of one case in seconds */
+constexpr double BENCHMARK_MIN_SECONDS = 0.2;
+/** Maximal count of iterations of one case */
+constexpr std::size_t BENCHMARK_MAX_ITERATIONS = 1'000'000;
+/** Default largest operand size in bits */
+constexpr std::size_t BENCHMARK_MAX_BITS = 10'000'000;
+/** Operand sizes of unlimited precision in bits */
+constexpr std::size_t BENCHMARK_SIZES[] = {64, 256, 1024, 4096, 16384, 65536, 262144, 1048576, 4194304, 10000000};
+
+/**
+ * @brief Result of one benchmark case.
+ */
+struct MpBenchmarkResult {
+    /** Name of operation */
+    std::string operation;
+    /** Name of precision ("unlimited" or bits) */
+    std::string precision;
+    /** Operand size in bits */
+    std::size_t bits;
+    /** Count of measured iterations */
+    std::size_t iterations;
+    /** Average time of one iteration */
+    double nanoseconds;
+    /**
+     * "ok", "timeout" (one iteration exceeded budget), "skipped" (predicted to exceed budget) or "overflow"
+     * (bounded precision overflowed)
+     */
+    std::string status;
+};
+
+/**
+ * @brief Self-contained benchmark of MpInt operations across operand sizes and precisions.
+ * Every case is measured until minimal time passes; operations exceeding time budget are cancelled through
+ * MpProgress and larger sizes of the same operation are skipped.
+ */
+class MpBenchmark {
+    // ------------------------------------------------------
+    // ------------------------------------------------------
+    // ------------------ VARIABLES -------------------------
+    // ------------------------------------------------------
+    // ------------------------------------------------------
+private:
+    /** Time limit of one operation */
+    std::chrono::duration<double> budget;
+    /** Largest operand size in bits */
+    std::size_t maxBits;
+    /** Source of random operands (fixed seed for comparable runs) */
+    MpRandom engine{20240601};
+    /** Measured results */
+    std::vector<MpBenchmarkResult> results;
+    /** Operations (by operation and precision) whose larger sizes are skipped */
+    std::map<std::string, bool> skipped;
+    /** Consumer of results, keeps measured operations from being optimized out */
+    volatile bool consumer = false;
+
+    // ------------------------------------------------------
+    // ------------------------------------------------------
+    // ------------------ CONSTRUCTORS ----------------------
+    // ------------------------------------------------------
+    // ------------------------------------------------------
+public:
+    /**
+     * @param budgetSeconds Time limit of one operation in seconds.
+     * @param maxBits Largest operand size in bits.
+     */
+    MpBenchmark(double budgetSeconds, std::size_t maxBits) : budget(budgetSeconds), maxBits(maxBits) {
+    }
+
+    // ------------------------------------------------------
+    // ------------------------------------------------------
+    // ------------------ METHODS ---------------------------
+    // ------------------------------------------------------
+    // ------------------------------------------------------
+public:
+    /**
+     * @brief Run all cases: unlimited precision across all sizes, bounded precisions with operands of half
+     * precision (minus carry and sign bit, so that sums and products do not overflow).
+     */
+    void run() {
+        for (auto bits: BENCHMARK_SIZES) {
+            if (bits <= maxBits) {
+                runSize<MP_INT_UNLIMITED>("unlimited", bits);
+            }
+        }
+        runSize<8>("64", 8 * 8 / 2 - 2);
+        runSize<128>("1024", 128 * 8 / 2 - 2);
+        runSize<1024>("8192", 1024 * 8 / 2 - 2);
+    }
+
+    /**
+     * @brief Write results as CSV with header.
+     */
+    void writeCsv(std::ostream &stream) const {
+        stream << "operation,precision,bits,iterations,ns_per_op,status\n";
+        for (const auto &result: results) {
+            stream << result.operation << ',' << result.precision << ',' << result.bits << ',' << result.iterations
+                   << ',' << static_cast<std::uint64_t>(result.nanoseconds) << ',' << result.status << '\n';
+        }
+        stream.flush();
+    }
+
+    /**
+     * @brief Write results as JSON array of objects.
+     */
+    void writeJson(std::ostream &stream) const {
+        stream << "[\n";
+        for (std::size_t i = 0; i < results.size(); i++) {
+            const auto &result = results[i];
+            stream << "  {\"operation\":\"" << result.operation << "\",\"precision\":\"" << result.precision
+                   << "\",\"bits\":" << result.bits << ",\"iterations\":" << result.iterations << ",\"ns_per_op\":"
+                   << static_cast<std::uint64_t>(result.nanoseconds) << ",\"status\":\"" << result.status << "\"}"
+                   << (i + 1 < results.size() ? ",\n" : "\n");
+        }
+        stream << "]" << std::endl;
+    }
+
+private:
+    /**
+     * @brief Make random positive number with exactly given count of bits.
+     */
+    template<std::size_t bytePrecision>
+    MpInt<bytePrecision> randomNumber(std::size_t bits) {
+        auto value = MpInt<bytePrecision>::random(bits, engine);
+        value.setBit(static_cast<int>(bits - 1));
+        return value;
+    }
+
+    /**
+     * @brief Make random decimal digits of number with about given count of bits.
+     */
+    std::string randomDecimal(std::size_t bits) {
+        std::string digits(std::max<std::size_t>(1, static_cast<std::size_t>(bits * std::log10(2.0))), '0');
+        std::uniform_int_distribution<int> digit(0, 9);
+        for (auto &character: digits) {
+            character = static_cast<char>('0' + digit(engine));
+        }
+        digits[0] = static_cast<char>('1' + digit(engine) % 9);
+        return digits;
+    }
+
+    /**
+     * @return Smallest n whose factorial has at least given count of bits.
+     */
+    static long long factorialArgument(std::size_t bits) {
+        long long n = 1;
+        while (std::lgamma(static_cast<double>(n) + 1) / std::log(2.0) < static_cast<double>(bits)) {
+            n++;
+        }
+        return n;
+    }
+
+    /**
+     * @brief Run all operations with operands of given size.
+     */
+    template<std::size_t bytePrecision>
+    void runSize(const std::string &precision, std::size_t bits) {
+        auto a = randomNumber<bytePrecision>(bits);
+        auto b = randomNumber<bytePrecision>(bits);
+        auto divisor = randomNumber<bytePrecision>(std::max<std::size_t>(1, bits / 2));
+        auto equal = a;
+        auto decimal = randomDecimal(bits);
+        auto factorialOf = MpInt<bytePrecision>(factorialArgument(bits));
+        // F(n) < 2^(0.695 n), C(2m, m) < 4^m
+        auto fibonacciOf = MpInt<bytePrecision>(static_cast<long long>(static_cast<double>(bits - 1) / 0.695));
+        auto binomialOf = MpInt<bytePrecision>(static_cast<long long>(std::max<std::size_t>(1, bits / 2 - 1)));
+
+        measure("add", precision, bits, [&] { consume(a + b); });
+        measure("subtract", precision, bits, [&] { consume(a - b); });
+        MpAccumulator accumulator;
+        measure("accumulate", precision, bits, [&] { accumulator += a; });
+        consume(accumulator.get());
+        measure("multiply", precision, bits, [&] { consume(a * b); });
+        measure("divide", precision, bits, [&] { consume(a / divisor); });
+        std::vector<MpInt<bytePrecision>> factors;
+        for (std::size_t i = 0; i < std::max<std::size_t>(1, bits / ELEMENT_BIT_SIZE); i++) {
+            factors.push_back(randomNumber<bytePrecision>(std::min<std::size_t>(bits, ELEMENT_BIT_SIZE - 2)));
+        }
+        measure("product", precision, bits, [&] { consume(MpProduct::product<bytePrecision>(factors)); });
+        measure("factorial", precision, bits, [&] { consume(factorialOf.factorial()); });
+        measure("fibonacci", precision, bits, [&] { consume(MpCombinatorics::fib(fibonacciOf)); });
+        measure("binomial", precision, bits, [&] {
+            consume(MpCombinatorics::binomial(binomialOf + binomialOf, binomialOf));
+        });
+        auto money = MpDecimal<bytePrecision, 2>::fromMantissa(divisor);
+        measure("decimal_multiply", precision, bits, [&] { consume((money * money).getMantissa()); });
+        // basis and residues are quadratic, they are prepared only for measured cases
+        std::optional<MpRns> aResidues, bResidues;
+        auto prepareResidues = [&] {
+            if (!aResidues) {
+                auto basis = MpRns::makeBasis(2 * bits + 1);
+                MpRns aConverted(a, basis), bConverted(b, basis);
+                aResidues = std::move(aConverted);
+                bResidues = std::move(bConverted);
+            }
+        };
+        measure("rns_multiply", precision, bits, [&] {
+            consumer = consumer ^ ((*aResidues * *bResidues).getResidues()[0] == 0);
+        }, prepareResidues);
+        measure("rns_reconstruct", precision, bits, [&] { consume(aResidues->toInt()); }, prepareResidues);
+        measure("sqrt", precision, bits, [&] { consume(a.abs().sqrt()); });
+        measure("pi", precision, bits, [&] {
+            consume(MpConstants::pi(static_cast<std::size_t>(static_cast<double>(bits) * std::log10(2.0))));
+        });
+        measure("next_prime", precision, bits, [&] { consume(MpPrime::nextPrime(a)); });
+        measure("shift_left", precision, bits, [&] {
+            auto copy = a;
+            copy <<= 1;
+            consume(copy);
+        });
+        measure("shift_right", precision, bits, [&] {
+            auto copy = a;
+            copy >>= 1;
+            consume(copy);
+        });
+        measure("random", precision, bits, [&] { consume(MpInt<bytePrecision>::random(bits, engine)); });
+        measure("compare", precision, bits, [&] { consumer = consumer ^ (a < equal); });
+        measure("to_decimal", precision, bits, [&] { consumer = consumer ^ a.toDecimal().empty(); });
+        measure("from_decimal", precision, bits, [&] {
+            consume(MpInt<bytePrecision>::fromDecimal(decimal));
+        });
+    }
+
+    /**
+     * @brief Consume result so that computation is not optimized out.
+     */
+    template<std::size_t bytePrecision>
+    void consume(const MpInt<bytePrecision> &value) {
+        consumer = consumer ^ value.isNegative();
+    }
+
+    /**
+     * @brief Measure one case and record result.
+     * @param operation Name of operation.
+     * @param precision Name of precision.
+     * @param bits Operand size in bits.
+     * @param body Measured operation.
+     * @param prepare Preparation of operands, it runs only if the case is not skipped and its time counts to budget.
+     */
+    void measure(const std::string &operation, const std::string &precision, std::size_t bits,
+                 const std::function<void()> &body, const std::function<void()> &prepare = {}) {
+        auto key = operation + '/' + precision;
+        if (skipped[key]) {
+            record({operation, precision, bits, 0, 0, "skipped"});
+            return;
+        }
+        MpProgress progress;
+        auto start = std::chrono::steady_clock::now();
+        progress.setDeadline(start + std::chrono::duration_cast<std::chrono::steady_clock::duration>(budget));
+        MpProgress::Installer installer(progress);
+        std::size_t iterations = 0;
+        std::chrono::duration<double> elapsed{}, preparation{};
+        try {
+            auto measured = start;
+            if (prepare) {
+                prepare();
+                measured = std::chrono::steady_clock::now();
+                preparation = measured - start;
+            }
+            do {
+                body();
+                iterations++;
+                elapsed = std::chrono::steady_clock::now() - measured;
+            } while (elapsed.count() < BENCHMARK_MIN_SECONDS && iterations < BENCHMARK_MAX_ITERATIONS);
+        } catch (MpIntCancelled &) {
+            skipped[key] = true;
+            record({operation, precision, bits, iterations, 0, "timeout"});
+            return;
+        } catch (MpIntException<MpInt<MP_INT_UNLIMITED>> &) {
+            record({operation, precision, bits, iterations, 0, "overflow"});
+            return;
+        }
+        auto nanoseconds = elapsed.count() * 1e9 / static_cast<double>(iterations);
+        // next size is at most 4 times larger, assume at most quadratic growth
+        if ((nanoseconds + preparation.count() * 1e9) * 16 > budget.count() * 1e9) {
+            skipped[key] = true;
+        }
+        record({operation, precision, bits, iterations, nanoseconds, "ok"});
+    }
+
+    /**
+     * @brief Store result and report progress to standard error.
+     */
+    void record(MpBenchmarkResult &&result) {
+        std::cerr << result.operation << ' ' << result.precision << ' ' << result.bits << ": " << result.status
+                  << ' ' << static_cast<std::uint64_t>(result.nanoseconds) << " ns" << std::endl;
+        results.push_back(std::move(result));
+    }
+};
+
+void printHelp() {
+    std::cout << "Benchmark [--json] [--output soubor] [--max-bits N] [--budget sekundy]" << std::endl;
+    std::cout << "  --json      vystup ve formatu JSON (vychozi je CSV)" << std::endl;
+    std::cout << "  --output    soubor pro vysledky (vychozi je standardni vystup)" << std::endl;
+    std::cout << "  --max-bits  nejvetsi velikost operandu v bitech (vychozi " << BENCHMARK_MAX_BITS << ")"
+              << std::endl;
+    std::cout << "  --budget    casovy limit jedne operace (vychozi " << BENCHMARK_BUDGET_SECONDS << " s)"
+              << std::endl;
+}
+
+int main(int argc, char **argv) {
+    bool json = false;
+    std::string output;
+    std::size_t maxBits = BENCHMARK_MAX_BITS;
+    double budget = BENCHMARK_BUDGET_SECONDS;
+    for (int i = 1; i < argc; i++) {
+        std::string argument(argv[i]);
+        if (argument == "--json") {
+            json = true;
+        } else if (argument == "--output" && i + 1 < argc) {
+            output = argv[++i];
+        } else if (argument == "--max-bits" && i + 1 < argc) {
+            maxBits = std::stoull(argv[++i]);
+        } else if (argument == "--budget" && i + 1 < argc) {
+            budget = std::stod(argv[++i]);
+        } else {
+            printHelp();
+            return EXIT_FAILURE;
+        }
+    }
+    if (!MpStorage::configureFromEnvironment()) {
+        std::cerr << "Neplatna hodnota MPINT_MAP_THRESHOLD, mapovani zustava vypnute." << std::endl;
+    }
+    std::cerr << "Jadra: " << MpKernels::getVariant() << std::endl;
+    MpBenchmark benchmark(budget, maxBits);
+    benchmark.run();
+    std::ofstream file;
+    if (!output.empty()) {
+        file.open(output);
+        if (!file) {
+            std::cerr << "Soubor " << output << " nelze otevrit." << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+    std::ostream &stream = output.empty() ? std::cout : file;
+    if (json) {
+        benchmark.writeJson(stream);
+    } else {
+        benchmark.writeCsv(stream);
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,610 @@
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <iostream>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include "MpInt.h"
+#include "MpRandom.h"
+#include "MpRns.h"
+
+/** Default largest operand size in bits of reference checks */
+constexpr std::size_t FUZZ_MAX_BITS = 256;
+/** Default count of iterations per thread */
+constexpr std::size_t FUZZ_ITERATIONS = 2000;
+/** Count of failures reported in detail */
+constexpr std::size_t FUZZ_REPORTED_FAILURES = 20;
+/** Operators of binary checks */
+constexpr char FUZZ_OPERATORS[] = {'+', '-', '*', '/'};
+
+/**
+ * @brief Simple and slow sign-magnitude reference integer with 32-bit limbs. Kept deliberately naive so that it
+ * shares no code with MpInt.
+ */
+class MpReferenceInt {
+private:
+    /** Magnitude limbs, least significant first, without leading zeros */
+    std::vector<std::uint32_t> magnitude;
+    /** Sign, false for zero */
+    bool negative = false;
+
+public:
+    MpReferenceInt() = default;
+
+    /**
+     * @param value Value of small number.
+     */
+    explicit MpReferenceInt(__int128 value) {
+        negative = value < 0;
+        auto absolute = negative ? -static_cast<unsigned __int128>(value) : static_cast<unsigned __int128>(value);
+        while (absolute != 0) {
+            magnitude.push_back(static_cast<std::uint32_t>(absolute));
+            absolute >>= 32;
+        }
+    }
+
+    /**
+     * @param text Hexadecimal digits with optional leading '-'.
+     * @return Parsed number.
+     */
+    static MpReferenceInt fromHex(const std::string &text) {
+        MpReferenceInt result;
+        std::size_t begin = text.starts_with('-') ? 1 : 0;
+        std::size_t position = 0;
+        for (auto i = text.size(); i-- > begin; position += 4) {
+            auto character = text[i];
+            std::uint32_t digit = character <= '9' ? character - '0' : character - 'a' + 10;
+            if (position / 32 == result.magnitude.size()) {
+                result.magnitude.push_back(0);
+            }
+            result.magnitude[position / 32] |= digit << (position % 32);
+        }
+        result.negative = begin == 1;
+        result.trim();
+        return result;
+    }
+
+    /**
+     * @return Hexadecimal digits with leading '-' if negative, "0" for zero.
+     */
+    [[nodiscard]] std::string toHex() const {
+        if (magnitude.empty()) {
+            return "0";
+        }
+        std::string text;
+        for (auto limb: magnitude) {
+            for (int i = 0; i < 8; i++, limb >>= 4) {
+                text += "0123456789abcdef"[limb & 15];
+            }
+        }
+        while (text.size() > 1 && text.back() == '0') {
+            text.pop_back();
+        }
+        if (negative) {
+            text += '-';
+        }
+        return {text.rbegin(), text.rend()};
+    }
+
+    /**
+     * @return Decimal digits with leading '-' if negative.
+     */
+    [[nodiscard]] std::string toDecimal() const {
+        if (magnitude.empty()) {
+            return "0";
+        }
+        auto words = magnitude;
+        std::string text;
+        while (!words.empty()) {
+            std::uint64_t remainder = 0;
+            for (auto i = words.size(); i-- > 0;) {
+                auto current = (remainder << 32) | words[i];
+                words[i] = static_cast<std::uint32_t>(current / 1000000000);
+                remainder = current % 1000000000;
+            }
+            while (!words.empty() && words.back() == 0) {
+                words.pop_back();
+            }
+            for (int i = 0; i < 9 && (!words.empty() || remainder != 0); i++, remainder /= 10) {
+                text += static_cast<char>('0' + remainder % 10);
+            }
+        }
+        if (negative) {
+            text += '-';
+        }
+        return {text.rbegin(), text.rend()};
+    }
+
+    /**
+     * @return True if number fits two's complement of given bits.
+     */
+    [[nodiscard]] bool fits(std::size_t bits) const {
+        auto length = bitLength();
+        if (length < bits) {
+            return true;
+        }
+        // only -2^(bits-1) has bit length equal to bits
+        if (!negative || length > bits) {
+            return false;
+        }
+        for (std::size_t i = 0; i + 1 < bits; i++) {
+            if ((magnitude[i / 32] >> (i % 32)) & 1) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    [[nodiscard]] bool isZero() const {
+        return magnitude.empty();
+    }
+
+    /**
+     * @return Negative, zero or positive value as a is less, equal or greater than b.
+     */
+    static int compare(const MpReferenceInt &a, const MpReferenceInt &b) {
+        if (a.negative != b.negative) {
+            return a.negative ? -1 : 1;
+        }
+        auto magnitudeOrder = compareMagnitude(a.magnitude, b.magnitude);
+        return a.negative ? -magnitudeOrder : magnitudeOrder;
+    }
+
+    /**
+     * @brief Apply binary operator, division truncates toward zero.
+     */
+    static MpReferenceInt apply(char oper, const MpReferenceInt &a, const MpReferenceInt &b) {
+        MpReferenceInt result;
+        switch (oper) {
+            case '+':
+            case '-': {
+                bool bNegative = oper == '-' ? !b.negative : b.negative;
+                if (a.negative == bNegative) {
+                    result.magnitude = addMagnitude(a.magnitude, b.magnitude);
+                    result.negative = a.negative;
+                } else if (compareMagnitude(a.magnitude, b.magnitude) >= 0) {
+                    result.magnitude = subtractMagnitude(a.magnitude, b.magnitude);
+                    result.negative = a.negative;
+                } else {
+                    result.magnitude = subtractMagnitude(b.magnitude, a.magnitude);
+                    result.negative = bNegative;
+                }
+                break;
+            }
+            case '*':
+                result.magnitude = multiplyMagnitude(a.magnitude, b.magnitude);
+                result.negative = a.negative != b.negative;
+                break;
+            case '/':
+                result.magnitude = divideMagnitude(a.magnitude, b.magnitude);
+                result.negative = a.negative != b.negative;
+                break;
+            default:
+                break;
+        }
+        result.trim();
+        return result;
+    }
+
+private:
+    /**
+     * @brief Remove leading zero limbs and sign of zero.
+     */
+    void trim() {
+        while (!magnitude.empty() && magnitude.back() == 0) {
+            magnitude.pop_back();
+        }
+        negative = negative && !magnitude.empty();
+    }
+
+    [[nodiscard]] std::size_t bitLength() const {
+        return magnitude.empty() ? 0 : (magnitude.size() - 1) * 32 + std::bit_width(magnitude.back());
+    }
+
+    static int compareMagnitude(const std::vector<std::uint32_t> &a, const std::vector<std::uint32_t> &b) {
+        if (a.size() != b.size()) {
+            return a.size() < b.size() ? -1 : 1;
+        }
+        for (auto i = a.size(); i-- > 0;) {
+            if (a[i] != b[i]) {
+                return a[i] < b[i] ? -1 : 1;
+            }
+        }
+        return 0;
+    }
+
+    static std::vector<std::uint32_t> addMagnitude(const std::vector<std::uint32_t> &a,
+                                                   const std::vector<std::uint32_t> &b) {
+        std::vector<std::uint32_t> result(std::max(a.size(), b.size()) + 1);
+        std::uint64_t carry = 0;
+        for (std::size_t i = 0; i < result.size(); i++) {
+            carry += static_cast<std::uint64_t>(i < a.size() ? a[i] : 0) + (i < b.size() ? b[i] : 0);
+            result[i] = static_cast<std::uint32_t>(carry);
+            carry >>= 32;
+        }
+        return result;
+    }
+
+    /** Magnitude a - b, requires a >= b */
+    static std::vector<std::uint32_t> subtractMagnitude(const std::vector<std::uint32_t> &a,
+                                                        const std::vector<std::uint32_t> &b) {
+        std::vector<std::uint32_t> result(a.size());
+        std::int64_t borrow = 0;
+        for (std::size_t i = 0; i < a.size(); i++) {
+            auto difference = static_cast<std::int64_t>(a[i]) - (i < b.size() ? b[i] : 0) - borrow;
+            borrow = difference < 0;
+            result[i] = static_cast<std::uint32_t>(difference + (borrow << 32));
+        }
+        return result;
+    }
+
+    static std::vector<std::uint32_t> multiplyMagnitude(const std::vector<std::uint32_t> &a,
+                                                        const std::vector<std::uint32_t> &b) {
+        std::vector<std::uint32_t> result(a.size() + b.size());
+        for (std::size_t i = 0; i < a.size(); i++) {
+            std::uint64_t carry = 0;
+            for (std::size_t j = 0; j < b.size(); j++) {
+                carry += static_cast<std::uint64_t>(a[i]) * b[j] + result[i + j];
+                result[i + j] = static_cast<std::uint32_t>(carry);
+                carry >>= 32;
+            }
+            result[i + b.size()] = static_cast<std::uint32_t>(carry);
+        }
+        return result;
+    }
+
+    /** Quotient of bit-by-bit long division, requires nonzero b */
+    static std::vector<std::uint32_t> divideMagnitude(const std::vector<std::uint32_t> &a,
+                                                      const std::vector<std::uint32_t> &b) {
+        std::vector<std::uint32_t> quotient(a.size());
+        std::vector<std::uint32_t> remainder;
+        for (auto bit = a.size() * 32; bit-- > 0;) {
+            remainder = addMagnitude(remainder, remainder);
+            remainder[0] |= (a[bit / 32] >> (bit % 32)) & 1;
+            while (!remainder.empty() && remainder.back() == 0) {
+                remainder.pop_back();
+            }
+            if (compareMagnitude(remainder, b) >= 0) {
+                remainder = subtractMagnitude(remainder, b);
+                while (!remainder.empty() && remainder.back() == 0) {
+                    remainder.pop_back();
+                }
+                quotient[bit / 32] |= std::uint32_t(1) << (bit % 32);
+            }
+        }
+        return quotient;
+    }
+};
+
+/**
+ * @brief Multithreaded differential fuzzer of MpInt. Results of unlimited and bounded MpInt are checked against
+ * __int128 and MpReferenceInt. Bounded MpInt<N> must return the exact result if it fits two's complement of N*8
+ * bits and throw MpIntException holding the exact result otherwise.
+ */
+class MpFuzzer {
+    // ------------------------------------------------------
+    // ------------------------------------------------------
+    // ------------------ VARIABLES -------------------------
+    // ------------------------------------------------------
+    // ------------------------------------------------------
+private:
+    /** Largest operand size in bits */
+    std::size_t maxBits;
+    /** Count of performed checks */
+    std::atomic<std::size_t> checks = 0;
+    /** Count of failed checks */
+    std::atomic<std::size_t> failures = 0;
+    /** Guard of failure reports */
+    std::mutex reportMutex;
+
+    // ------------------------------------------------------
+    // ------------------------------------------------------
+    // ------------------ CONSTRUCTORS ----------------------
+    // ------------------------------------------------------
+    // ------------------------------------------------------
+public:
+    /**
+     * @param maxBits Largest operand size in bits of reference checks.
+     */
+    explicit MpFuzzer(std::size_t maxBits) : maxBits(std::max<std::size_t>(maxBits, 1)) {
+    }
+
+    // ------------------------------------------------------
+    // ------------------------------------------------------
+    // ------------------ METHODS ---------------------------
+    // ------------------------------------------------------
+    // ------------------------------------------------------
+public:
+    /**
+     * @brief Run fuzzing on threads, each with own non-overlapping sequence of engine seeded from seed.
+     * @return Count of failed checks.
+     */
+    std::size_t run(std::size_t threads, std::size_t iterations, std::uint64_t seed) {
+        std::vector<std::thread> workers;
+        for (std::size_t thread = 0; thread < threads; thread++) {
+            workers.emplace_back([this, iterations, seed, thread] {
+                MpRandom engine(seed);
+                for (std::size_t jump = 0; jump < thread; jump++) {
+                    engine.jump();
+                }
+                for (std::size_t i = 0; i < iterations; i++) {
+                    iterate(engine);
+                }
+            });
+        }
+        for (auto &worker: workers) {
+            worker.join();
+        }
+        return failures;
+    }
+
+    /**
+     * @brief Check all operations and precisions on one pair of operands.
+     * @param a First operand.
+     * @param b Second operand.
+     */
+    void checkPair(const MpReferenceInt &a, const MpReferenceInt &b) {
+        checkPrecision<MP_INT_UNLIMITED>(a, b);
+        checkPrecision<4>(a, b);
+        checkPrecision<8>(a, b);
+        checkPrecision<16>(a, b);
+        checkPrecision<64>(a, b);
+    }
+
+    /**
+     * @brief Check operations of unlimited and 64-bit MpInt against __int128.
+     */
+    void checkInt128(long long a, long long b) {
+        for (auto oper: FUZZ_OPERATORS) {
+            if (oper == '/' && b == 0) {
+                continue;
+            }
+            auto exact = applyInt128(oper, a, b);
+            auto expected = toDecimal(exact);
+            auto description = std::string("int128 ") + std::to_string(a) + ' ' + oper + ' ' + std::to_string(b);
+            auto [unlimited, unlimitedOverflow] = apply(oper, MpInt<MP_INT_UNLIMITED>(a), MpInt<MP_INT_UNLIMITED>(b));
+            check(!unlimitedOverflow && unlimited.toDecimal() == expected, description + " (unlimited)");
+            bool fits = exact >= INT64_MIN && exact <= INT64_MAX;
+            auto [bounded, boundedOverflow] = apply(oper, MpInt<8>(a), MpInt<8>(b));
+            check(boundedOverflow != fits && bounded.toDecimal() == expected, description + " (64 bit)");
+        }
+    }
+
+    [[nodiscard]] std::size_t getChecks() const {
+        return checks;
+    }
+
+    [[nodiscard]] std::size_t getFailures() const {
+        return failures;
+    }
+
+private:
+    /**
+     * @brief One fuzzing iteration: one __int128 check and one reference check of random operands.
+     */
+    void iterate(MpRandom &engine) {
+        checkInt128(randomWord(engine), randomWord(engine));
+        auto a = randomNumber(engine, randomBits(engine));
+        auto bits = randomBits(engine);
+        auto b = randomNumber(engine, bits);
+        checkPair(a, b);
+    }
+
+    /**
+     * @return Random 64-bit value biased to boundaries.
+     */
+    static long long randomWord(MpRandom &engine) {
+        switch (engine() % 8) {
+            case 0:
+                return static_cast<long long>(engine() % 5) - 2;
+            case 1:
+                return static_cast<long long>(INT64_MAX - engine() % 3);
+            case 2:
+                return static_cast<long long>(INT64_MIN + engine() % 3);
+            case 3: {
+                auto power = static_cast<long long>(std::uint64_t(1) << (engine() % 63));
+                return (engine() % 2 ? power : -power) + static_cast<long long>(engine() % 3) - 1;
+            }
+            default:
+                return static_cast<long long>(engine()) >> (engine() % 64);
+        }
+    }
+
+    /**
+     * @return Random size in bits biased to word boundaries.
+     */
+    std::size_t randomBits(MpRandom &engine) const {
+        if (engine() % 4 == 0) {
+            auto words = engine() % std::max<std::size_t>(maxBits / 64, 1) + 1;
+            return std::clamp<std::size_t>(words * 64 + engine() % 3 - 1, 1, maxBits);
+        }
+        return engine() % maxBits + 1;
+    }
+
+    /**
+     * @return Random number of at most given bits with random sign, biased to all-ones and single-bit patterns.
+     */
+    static MpReferenceInt randomNumber(MpRandom &engine, std::size_t bits) {
+        auto pattern = engine() % 8;
+        std::string hex;
+        if (pattern > 1) {
+            hex = MpInt<MP_INT_UNLIMITED>::random(bits, engine).toHex();
+        } else {
+            hex.assign((bits + 3) / 4, pattern == 0 ? 'f' : '0');
+            if (pattern == 1) {
+                hex[engine() % hex.size()] = '1';
+            }
+            if (bits % 4 != 0) {
+                auto top = (hex[0] <= '9' ? hex[0] - '0' : hex[0] - 'a' + 10) & ((1 << (bits % 4)) - 1);
+                hex[0] = "0123456789abcdef"[top];
+            }
+        }
+        return MpReferenceInt::fromHex(engine() % 2 ? '-' + hex : hex);
+    }
+
+    /**
+     * @brief Check all operations of one precision on operands fitting that precision.
+     */
+    template<std::size_t bytePrecision>
+    void checkPrecision(const MpReferenceInt &a, const MpReferenceInt &b) {
+        if (bytePrecision != MP_INT_UNLIMITED && (!a.fits(bytePrecision * 8) || !b.fits(bytePrecision * 8))) {
+            return;
+        }
+        auto x = MpInt<bytePrecision>::fromHex(a.toHex());
+        auto y = MpInt<bytePrecision>::fromHex(b.toHex());
+        auto prefix = "precision " + std::to_string(bytePrecision * 8) + ": " + a.toHex() + ' ';
+        for (auto oper: FUZZ_OPERATORS) {
+            if (oper == '/' && b.isZero()) {
+                continue;
+            }
+            auto exact = MpReferenceInt::apply(oper, a, b);
+            auto fits = bytePrecision == MP_INT_UNLIMITED || exact.fits(bytePrecision * 8);
+            auto [result, overflow] = apply(oper, x, y);
+            check(overflow != fits && result.toHex() == exact.toHex(), prefix + oper + ' ' + b.toHex());
+        }
+        auto order = MpReferenceInt::compare(a, b);
+        check((x < y) == (order < 0) && (x <= y) == (order <= 0) && (x > y) == (order > 0) &&
+              (x >= y) == (order >= 0) && (x == y) == (order == 0), prefix + "<=> " + b.toHex());
+        check(x.toDecimal() == a.toDecimal(), prefix + "toDecimal");
+        check(MpInt<bytePrecision>::fromDecimal(a.toDecimal()).toHex() == a.toHex(), prefix + "fromDecimal");
+        if constexpr (bytePrecision == MP_INT_UNLIMITED) {
+            // square root against multiplication, which is checked against reference above
+            auto magnitude = x.abs();
+            auto root = magnitude.sqrt();
+            auto next = root + MpInt<bytePrecision>(1LL);
+            check(root * root <= magnitude && next * next > magnitude, prefix + "sqrt");
+            // residues against multiplication, basis covers x * y - y
+            auto basis = MpRns::makeBasis(4 * (a.toHex().size() + b.toHex().size()) + 1);
+            MpRns u(x, basis), v(y, basis);
+            check((u * v - v).toInt() == x * y - y && (u + v).toInt() == x + y, prefix + "rns " + b.toHex());
+        }
+    }
+
+    /**
+     * @brief Apply operator to MpInt.
+     * @return Result (or overflowed exact result) and flag of MpIntException.
+     */
+    template<std::size_t bytePrecision>
+    static std::pair<MpInt<MP_INT_UNLIMITED>, bool>
+    apply(char oper, const MpInt<bytePrecision> &x, const MpInt<bytePrecision> &y) {
+        try {
+            switch (oper) {
+                case '+':
+                    return {MpInt<MP_INT_UNLIMITED>(x + y), false};
+                case '-':
+                    return {MpInt<MP_INT_UNLIMITED>(x - y), false};
+                case '*':
+                    return {MpInt<MP_INT_UNLIMITED>(x * y), false};
+                default:
+                    return {MpInt<MP_INT_UNLIMITED>(x / y), false};
+            }
+        } catch (MpIntException<MpInt<MP_INT_UNLIMITED>> &e) {
+            return {e.overflow, true};
+        }
+    }
+
+    static __int128 applyInt128(char oper, long long a, long long b) {
+        switch (oper) {
+            case '+':
+                return static_cast<__int128>(a) + b;
+            case '-':
+                return static_cast<__int128>(a) - b;
+            case '*':
+                return static_cast<__int128>(a) * b;
+            default:
+                return static_cast<__int128>(a) / b;
+        }
+    }
+
+    static std::string toDecimal(__int128 value) {
+        return MpReferenceInt(value).toDecimal();
+    }
+
+    /**
+     * @brief Count check and report failure.
+     */
+    void check(bool passed, const std::string &description) {
+        checks++;
+        if (passed) {
+            return;
+        }
+        if (failures++ < FUZZ_REPORTED_FAILURES) {
+            std::lock_guard lock(reportMutex);
+            std::cerr << "FAILED: " << description << std::endl;
+        }
+    }
+};
+
+#ifdef MP_INT_LIBFUZZER
+
+/**
+ * @brief libFuzzer entry. First byte selects operand split, the rest are bytes of two operands (top bit of first
+ * byte of each operand is its sign).
+ */
+extern "C" int LLVMFuzzerTestOneInput(const std::uint8_t *data, std::size_t size) {
+    static MpFuzzer fuzzer(FUZZ_MAX_BITS);
+    if (size < 3) {
+        return 0;
+    }
+    auto split = 1 + data[0] % (size - 1);
+    auto toNumber = [](const std::uint8_t *begin, const std::uint8_t *end) {
+        std::string hex;
+        for (auto byte = begin; byte != end && hex.size() < FUZZ_MAX_BITS / 4; byte++) {
+            hex += "0123456789abcdef"[*byte >> 4];
+            hex += "0123456789abcdef"[*byte & 15];
+        }
+        bool negative = !hex.empty() && hex[0] >= '8';
+        if (negative) {
+            hex[0] = "01234567"[hex[0] <= '9' ? hex[0] - '8' : hex[0] - 'a' + 2];
+        }
+        return MpReferenceInt::fromHex(hex.empty() ? "0" : (negative ? "-" + hex : hex));
+    };
+    auto before = fuzzer.getFailures();
+    fuzzer.checkPair(toNumber(data + 1, data + split), toNumber(data + split, data + size));
+    if (fuzzer.getFailures() != before) {
+        __builtin_trap();
+    }
+    return 0;
+}
+
+#else
+
+void printHelp() {
+    std::cout << "Fuzz [--threads N] [--iterations N] [--max-bits N] [--seed N]" << std::endl;
+}
+
+int main(int argc, char **argv) {
+    std::size_t threads = std::max(1U, std::thread::hardware_concurrency());
+    std::size_t iterations = FUZZ_ITERATIONS;
+    std::size_t maxBits = FUZZ_MAX_BITS;
+    std::uint64_t seed = std::random_device()();
+    for (int i = 1; i + 1 < argc; i += 2) {
+        std::string argument(argv[i]);
+        if (argument == "--threads") {
+            threads = std::stoull(argv[i + 1]);
+        } else if (argument == "--iterations") {
+            iterations = std::stoull(argv[i + 1]);
+        } else if (argument == "--max-bits") {
+            maxBits = std::stoull(argv[i + 1]);
+        } else if (argument == "--seed") {
+            seed = std::stoull(argv[i + 1]);
+        } else {
+            printHelp();
+            return EXIT_FAILURE;
+        }
+    }
+    if (argc % 2 == 0) {
+        printHelp();
+        return EXIT_FAILURE;
+    }
+    std::cout << "Seed: " << seed << std::endl;
+    MpFuzzer fuzzer(maxBits);
+    auto failures = fuzzer.run(threads, iterations, seed);
+    std::cout << "Checks: " << fuzzer.getChecks() << ", failed: " << failures << std::endl;
+    return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+#endif
@@ -0,0 +1,160 @@
+#pragma once
+
+#include "MpInt.h"
+#include <vector>
+
+/** Lane of accumulator, holds sum of limbs of one position with deferred carries */
+typedef __int128 accumulatorLane;
+/**
+ * @brief Count of additions after which lanes are normalized. Every addition changes a lane by less than 2^64,
+ * so lanes stay below 2^126 and normalization carries do not overflow.
+ */
+constexpr std::uint64_t ACCUMULATOR_NORMALIZE_LIMIT = std::uint64_t(1) << 62;
+
+/**
+ * @brief Sum of many numbers with deferred carries. Every limb of an addend is added to its own 128-bit lane
+ * without carry propagation or allocation (except growth to longer addends), carries are resolved only when the sum
+ * is read. Partial sums of threads can be combined by merge.
+ */
+class MpAccumulator {
+    // ------------------------------------------------------
+    // ------------------------------------------------------
+    // ------------------ VARIABLES -------------------------
+    // ------------------------------------------------------
+    // ------------------------------------------------------
+private:
+    /** Lanes by limb position, value is sum of lane * 2^(64 * position) */
+    std::vector<accumulatorLane> lanes;
+    /** Count of additions since last normalization (bound of lanes in multiples of 2^64) */
+    std::uint64_t additions = 0;
+
+    // ------------------------------------------------------
+    // ------------------------------------------------------
+    // ------------------ METHODS ---------------------------
+    // ------------------------------------------------------
+    // ------------------------------------------------------
+public:
+    /**
+     * @brief Add number of any precision.
+     * @return This.
+     */
+    template<std::size_t bytePrecision>
+    MpAccumulator &operator+=(const MpInt<bytePrecision> &value) {
+        // two's complement limbs are added, sign means -2^(64 * size)
+        auto size = value.bitset.size();
+        prepare(size + 1);
+        for (std::size_t i = 0; i < size; i++) {
+            lanes[i] += static_cast<std::uint64_t>(value.bitset[i]);
+        }
+        if (value.isNegative()) {
+            lanes[size] -= 1;
+        }
+        return *this;
+    }
+
+    /**
+     * @brief Add native number.
+     * @return This.
+     */
+    MpAccumulator &operator+=(long long value) {
+        prepare(1);
+        lanes[0] += value;
+        return *this;
+    }
+
+    /**
+     * @brief Add partial sum of other accumulator (e.g. of other thread).
+     * @param other Added accumulator.
+     */
+    void merge(const MpAccumulator &other) {
+        if (other.lanes.empty()) {
+            return;
+        }
+        if (additions + other.additions >= ACCUMULATOR_NORMALIZE_LIMIT) {
+            auto normalized = other;
+            normalized.normalize();
+            normalize();
+            addLanes(normalized);
+        } else {
+            addLanes(other);
+        }
+    }
+
+    /**
+     * @brief Reset sum to zero.
+     */
+    void reset() {
+        lanes.clear();
+        additions = 0;
+    }
+
+    /**
+     * @brief Resolve carries and return sum. Throw MpIntException if number limitation is overflowed.
+     * @tparam bytePrecision Precision of result.
+     * @return Sum of all added numbers.
+     */
+    template<std::size_t bytePrecision = MP_INT_UNLIMITED>
+    [[nodiscard]] MpInt<bytePrecision> get() const {
+        bitsetStorage words;
+        words.reserve(lanes.size() + 2);
+        accumulatorLane carry = 0;
+        for (auto lane: lanes) {
+            carry += lane;
+            words.push_back(static_cast<bitsetItem>(static_cast<std::uint64_t>(carry)));
+            carry >>= 64;
+        }
+        while (carry != 0 && carry != -1) {
+            words.push_back(static_cast<bitsetItem>(static_cast<std::uint64_t>(carry)));
+            carry >>= 64;
+        }
+        return MpInt<bytePrecision>::fromTwosComplement(std::move(words), carry == -1);
+    }
+
+private:
+    /**
+     * @brief Count one addition and make sure that lanes cover given count of limbs.
+     */
+    void prepare(std::size_t size) {
+        if (additions >= ACCUMULATOR_NORMALIZE_LIMIT) {
+            normalize();
+        }
+        additions++;
+        if (lanes.size() < size) {
+            lanes.resize(size, 0);
+        }
+    }
+
+    /**
+     * @brief Resolve carries in place, so that lanes hold single limbs (top lane -1 for negative sum).
+     */
+    void normalize() {
+        accumulatorLane carry = 0;
+        for (auto &lane: lanes) {
+            carry += lane;
+            lane = static_cast<std::uint64_t>(carry);
+            carry >>= 64;
+        }
+        while (carry != 0 && carry != -1) {
+            lanes.push_back(static_cast<std::uint64_t>(carry));
+            carry >>= 64;
+        }
+        if (carry == -1) {
+            lanes.push_back(-1);
+        }
+        // normalized lanes are bounded as after one addition
+        additions = 1;
+    }
+
+    /**
+     * @brief Add lanes of other accumulator.
+     */
+    void addLanes(const MpAccumulator &other) {
+        if (lanes.size() < other.lanes.size()) {
+            lanes.resize(other.lanes.size(), 0);
+        }
+        for (std::size_t i = 0; i < other.lanes.size(); i++) {
+            lanes[i] += other.lanes[i];
+        }
+        additions += other.additions;
+    }
+};
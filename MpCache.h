@@ -0,0 +1,274 @@
+#pragma once
+
+#include "MpInt.h"
+#include <algorithm>
+#include <list>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @brief Default memory budget of result cache in bytes.
+ */
+constexpr std::size_t CACHE_BUDGET = 64 * 1024 * 1024;
+/**
+ * @brief Estimated bookkeeping bytes of one cache entry (list node, hash node, MpInt header).
+ */
+constexpr std::size_t CACHE_ENTRY_OVERHEAD = 128;
+
+/**
+ * @brief Thread-safe least recently used cache of operation results limited by memory budget.
+ * @tparam bytePrecision Maximal precision of cached numbers in bytes (0 is unlimited).
+ */
+template<std::size_t bytePrecision> requires SizeLimitation<bytePrecision>
+class MpResultCache {
+private:
+    /**
+     * @brief Inner structure for one cached result.
+     */
+    struct Entry {
+        /** Normalized operation key */
+        std::string key;
+        /** Cached result */
+        MpInt<bytePrecision> value;
+        /** Accounted size in bytes */
+        std::size_t size;
+    };
+
+    // ------------------------------------------------------
+    // ------------------------------------------------------
+    // ------------------ VARIABLES -------------------------
+    // ------------------------------------------------------
+    // ------------------------------------------------------
+private:
+    /** Maximal accounted size of all entries in bytes */
+    std::size_t budget;
+    /** Accounted size of all entries in bytes */
+    std::size_t used = 0;
+    /** Bytes held outside of entries and charged to budget */
+    std::size_t reserved = 0;
+    /** Entries ordered from most recently used */
+    std::list<Entry> entries;
+    /** Index of entries by key (views point into keys stored in entries) */
+    std::unordered_map<std::string_view, typename std::list<Entry>::iterator> index;
+    /** Count of successful lookups */
+    std::size_t hits = 0;
+    /** Count of failed lookups */
+    std::size_t misses = 0;
+    /** Guard of all variables */
+    mutable std::mutex mutex;
+
+    // ------------------------------------------------------
+    // ------------------------------------------------------
+    // ------------------ CONSTRUCTORS ----------------------
+    // ------------------------------------------------------
+    // ------------------------------------------------------
+public:
+    /**
+     * @param budget Maximal memory used by cached results in bytes.
+     */
+    explicit MpResultCache(std::size_t budget = CACHE_BUDGET) : budget(budget) {
+    }
+
+    // ------------------------------------------------------
+    // ------------------------------------------------------
+    // ------------------ METHODS ---------------------------
+    // ------------------------------------------------------
+    // ------------------------------------------------------
+public:
+    /**
+     * @brief Make key of binary operation. Operands of commutative operations are ordered, so a*b and b*a share key.
+     * @param oper Operator.
+     * @param a First operand.
+     * @param b Second operand.
+     * @return Normalized key.
+     */
+    static std::string makeKey(char oper, const MpInt<bytePrecision> &a, const MpInt<bytePrecision> &b) {
+        auto first = a.toHex();
+        auto second = b.toHex();
+        if ((oper == '+' || oper == '*') && second < first) {
+            std::swap(first, second);
+        }
+        return oper + first + ',' + second;
+    }
+
+    /**
+     * @brief Make key of unary operation.
+     * @param oper Operator.
+     * @param a Operand.
+     * @return Normalized key.
+     */
+    static std::string makeKey(char oper, const MpInt<bytePrecision> &a) {
+        return oper + a.toHex();
+    }
+
+    /**
+     * @brief Make key of function call, it differs from operator keys by leading letter.
+     * @param name Name of function.
+     * @param arguments Arguments.
+     * @return Normalized key.
+     */
+    static std::string makeKey(std::string_view name, const std::vector<MpInt<bytePrecision>> &arguments) {
+        std::string key(name);
+        for (const auto &argument: arguments) {
+            key += ',' + argument.toHex();
+        }
+        return key;
+    }
+
+    /**
+     * @brief Find cached result and mark it as most recently used.
+     * @param key Normalized key.
+     * @return Cached result or "nullopt".
+     */
+    std::optional<MpInt<bytePrecision>> find(const std::string &key) {
+        std::lock_guard lock(mutex);
+        auto it = index.find(key);
+        if (it == index.end()) {
+            misses++;
+            return std::nullopt;
+        }
+        hits++;
+        entries.splice(entries.begin(), entries, it->second);
+        return it->second->value;
+    }
+
+    /**
+     * @brief Insert result, evicting least recently used results over budget. Results larger than budget are
+     * not cached.
+     * @param key Normalized key.
+     * @param value Result.
+     */
+    void insert(const std::string &key, const MpInt<bytePrecision> &value) {
+        auto size = key.size() + value.getCurrentCapacity() / 8 + CACHE_ENTRY_OVERHEAD;
+        std::lock_guard lock(mutex);
+        if (size > budget - reserved || index.contains(key)) {
+            return;
+        }
+        evict(size);
+        entries.push_front({key, value, size});
+        index.emplace(entries.front().key, entries.begin());
+        used += size;
+    }
+
+    /**
+     * @brief Charge memory held outside of entries (the known factorial) to budget, evicting least recently used
+     * results over it.
+     * @param bytes Held memory in bytes, at most budget.
+     */
+    void reserve(std::size_t bytes) {
+        std::lock_guard lock(mutex);
+        reserved = std::min(bytes, budget);
+        evict(0);
+    }
+
+    /**
+     * @brief Print cache statistics.
+     * @param stream Output stream.
+     */
+    void printStatistics(std::ostream &stream) const {
+        std::lock_guard lock(mutex);
+        stream << "Cache: " << entries.size() << " vysledku, " << used + reserved << " z " << budget
+               << " B (faktorial " << reserved << " B), " << hits << " zasahu, " << misses << " minuti." << std::endl;
+    }
+
+private:
+    /**
+     * @brief Evict least recently used results until size more bytes fit budget. Caller holds mutex.
+     * @param size Bytes to be inserted.
+     */
+    void evict(std::size_t size) {
+        while (!entries.empty() && used + reserved + size > budget) {
+            used -= entries.back().size;
+            index.erase(entries.back().key);
+            entries.pop_back();
+        }
+    }
+};
+
+/**
+ * @brief Thread-safe cache of the largest computed factorial within memory budget. Factorials of greater numbers
+ * continue multiplying from it instead of starting at 2.
+ */
+class MpFactorialCache {
+private:
+    /** Maximal size of known factorial in bytes */
+    std::size_t budget;
+    /** Largest number whose factorial was computed */
+    MpInt<MP_INT_UNLIMITED> known{1LL};
+    /** Factorial of known */
+    MpInt<MP_INT_UNLIMITED> knownFactorial{1LL};
+    /** Size of knownFactorial in bytes */
+    std::size_t size = 0;
+    /** Guard of all variables */
+    mutable std::mutex mutex;
+
+public:
+    /**
+     * @param budget Maximal size of kept factorial in bytes, greater factorials are not kept.
+     */
+    explicit MpFactorialCache(std::size_t budget = CACHE_BUDGET) : budget(budget) {
+    }
+
+    /**
+     * @brief Compute factorial of number. Throw MpIntException if number limitation is overflowed.
+     * Partial progress of cancelled computation is kept.
+     * @param number Number.
+     * @return Factorial of number.
+     */
+    template<std::size_t bytePrecision>
+    requires SizeLimitation<bytePrecision>
+    MpInt<bytePrecision> get(const MpInt<bytePrecision> &number) {
+        MpInt<MP_INT_UNLIMITED> start(1LL);
+        MpInt<MP_INT_UNLIMITED> startFactorial(1LL);
+        {
+            std::lock_guard lock(mutex);
+            if (number >= known) {
+                start = known;
+                startFactorial = knownFactorial;
+            }
+        }
+        try {
+            auto result = number.factorial(start, startFactorial);
+            store(std::move(start), std::move(startFactorial));
+            return result;
+        } catch (...) {
+            // overflowed or cancelled computation still extends the known factorial
+            store(std::move(start), std::move(startFactorial));
+            throw;
+        }
+    }
+
+    /**
+     * @return Size of kept factorial in bytes.
+     */
+    [[nodiscard]] std::size_t getSize() const {
+        std::lock_guard lock(mutex);
+        return size;
+    }
+
+    /**
+     * @return Largest number whose factorial is kept.
+     */
+    [[nodiscard]] MpInt<MP_INT_UNLIMITED> getKnown() const {
+        std::lock_guard lock(mutex);
+        return known;
+    }
+
+private:
+    /**
+     * @brief Remember computed factorial if it is greater than known one and fits budget.
+     */
+    void store(MpInt<MP_INT_UNLIMITED> &&number, MpInt<MP_INT_UNLIMITED> &&numberFactorial) {
+        auto bytes = numberFactorial.getCurrentCapacity() / 8;
+        std::lock_guard lock(mutex);
+        if (number > known && bytes <= budget) {
+            known = std::move(number);
+            knownFactorial = std::move(numberFactorial);
+            size = bytes;
+        }
+    }
+};
@@ -0,0 +1,162 @@
+#pragma once
+
+#include "MpInt.h"
+#include "MpPrime.h"
+#include "MpProduct.h"
+#include <bit>
+#include <cmath>
+#include <ranges>
+#include <stdexcept>
+#include <vector>
+
+/** Largest n of binomial coefficient computed from prime factorization (all primes up to n are sieved) */
+constexpr std::uint64_t BINOMIAL_SIEVE_LIMIT = 1 << 26;
+/** Largest min(k, n - k) of binomial coefficient computed as quotient of products instead of factorization */
+constexpr std::uint64_t BINOMIAL_QUOTIENT_LIMIT = 256;
+/** Bits of Fibonacci number per index, log2 of golden ratio */
+constexpr double FIBONACCI_BITS_PER_INDEX = 0.69424191363061737991;
+
+/**
+ * @brief Combinatorial functions of any precision: Fibonacci numbers, binomial coefficients and multifactorials.
+ * Bounded results throw MpIntOverflowPredicted before any work if they certainly overflow and are large, otherwise
+ * MpIntException with exact value. Arguments which would need more than one word throw std::invalid_argument.
+ */
+class MpCombinatorics {
+    // ------------------------------------------------------
+    // ------------------------------------------------------
+    // ------------------ METHODS ---------------------------
+    // ------------------------------------------------------
+    // ------------------------------------------------------
+public:
+    /**
+     * @brief Fibonacci number by fast doubling with two squarings per bit of index:
+     * F(2k + 1) = 4 F(k)^2 - F(k - 1)^2 + 2 (-1)^k, F(2k - 1) = F(k)^2 + F(k - 1)^2, F(2k) = F(2k + 1) - F(2k - 1).
+     * @param n Index, negative indices follow F(-n) = (-1)^(n + 1) F(n).
+     * @return F(n).
+     */
+    template<std::size_t bytePrecision>
+    static MpInt<bytePrecision> fib(const MpInt<bytePrecision> &n) {
+        MpProgress::Scope progress("fibonacci");
+        auto index = getWord(n);
+        if (index == 0) {
+            return MpInt<bytePrecision>();
+        }
+        if (index > 2) {
+            // F(n) >= phi^(n - 2)
+            MpInt<bytePrecision>::checkPredictedOverflow(
+                    static_cast<std::size_t>(static_cast<double>(index - 2) * FIBONACCI_BITS_PER_INDEX *
+                                             (1 - 1e-12)) + 1);
+        }
+        // F(k) and F(k - 1) for k of bits above current one
+        MpInt<MP_INT_UNLIMITED> current(1LL), previous(0LL);
+        auto odd = true;
+        auto steps = static_cast<std::size_t>(std::bit_width(index)) - 1;
+        for (auto bit = steps; bit-- > 0;) {
+            auto square = current * current;
+            auto previousSquare = previous * previous;
+            auto next = MpInt<MP_INT_UNLIMITED>(4LL) * square - previousSquare +
+                        MpInt<MP_INT_UNLIMITED>(odd ? -2LL : 2LL);
+            auto before = square + previousSquare;
+            auto even = next - before;
+            odd = (index >> bit & 1) != 0;
+            if (odd) {
+                current = std::move(next);
+                previous = std::move(even);
+            } else {
+                current = std::move(even);
+                previous = std::move(before);
+            }
+            progress.report(steps - bit, steps);
+        }
+        return MpInt<bytePrecision>::fromMagnitude(current.getMagnitude(), n.isNegative() && index % 2 == 0);
+    }
+
+    /**
+     * @brief Binomial coefficient C(n, k). For n up to BINOMIAL_SIEVE_LIMIT it is product of prime powers, exponent
+     * of prime p is count of borrows of n - k in base p (Kummer), multiplied by product tree. Otherwise (or for
+     * small min(k, n - k)) it is quotient of products n (n - 1) ... (n - k + 1) and k!.
+     * @param n Nonnegative number of items (std::invalid_argument otherwise).
+     * @param k Count of chosen items, C(n, k) is zero for k < 0 or k > n.
+     * @return C(n, k).
+     */
+    template<std::size_t bytePrecision>
+    static MpInt<bytePrecision> binomial(const MpInt<bytePrecision> &n, const MpInt<bytePrecision> &k) {
+        if (n.isNegative()) {
+            throw std::invalid_argument("Negative argument.");
+        }
+        if (k.isNegative() || k > n) {
+            return MpInt<bytePrecision>();
+        }
+        auto rest = n - k;
+        auto low = getWord(rest < k ? rest : k);
+        auto nBits = MpInt<MP_INT_UNLIMITED>::getBitLength(n.getMagnitude());
+        if (low > 0) {
+            // C(n, k) >= (n / k)^k
+            auto bits = static_cast<double>(low) * (static_cast<double>(nBits - 1) - std::log2(low));
+            MpInt<bytePrecision>::checkPredictedOverflow(static_cast<std::size_t>(std::max(0.0, bits * (1 - 1e-9))));
+        }
+        auto sieved = n <= MpInt<MP_INT_UNLIMITED>(static_cast<long long>(BINOMIAL_SIEVE_LIMIT));
+        if (!sieved || low <= BINOMIAL_QUOTIENT_LIMIT) {
+            auto first = MpInt<MP_INT_UNLIMITED>(n) - MpInt<MP_INT_UNLIMITED>(static_cast<long long>(low));
+            auto numerator = MpProduct::product(std::views::iota(std::uint64_t(1), low + 1) |
+                                                std::views::transform([&first](std::uint64_t i) {
+                                                    return first + MpInt<MP_INT_UNLIMITED>(static_cast<long long>(i));
+                                                }));
+            auto quotient = numerator / MpProduct::product(std::views::iota(std::uint64_t(1), low + 1));
+            return MpInt<bytePrecision>::fromMagnitude(quotient.getMagnitude(), false);
+        }
+        auto top = getWord(n);
+        std::vector<std::uint64_t> factors;
+        for (auto prime: MpPrime::getPrimesBelow(top + 1)) {
+            std::uint64_t power = 1;
+            for (auto divisor = prime;; divisor *= prime) {
+                if (top / divisor - low / divisor - (top - low) / divisor != 0) {
+                    power *= prime;
+                }
+                if (divisor > top / prime) {
+                    break;
+                }
+            }
+            if (power > 1) {
+                factors.push_back(power);
+            }
+        }
+        return MpProduct::product<bytePrecision>(factors);
+    }
+
+    /**
+     * @brief Multifactorial n (n - m) (n - 2m) ... of positive factors, e.g. double factorial for m = 2.
+     * @param n Number, result is 1 for n < 1.
+     * @param m Positive step (std::invalid_argument otherwise).
+     * @return Multifactorial of n.
+     */
+    template<std::size_t bytePrecision>
+    static MpInt<bytePrecision> multifactorial(const MpInt<bytePrecision> &n, const MpInt<bytePrecision> &m) {
+        if (m.isNegative() || m == MpInt<bytePrecision>()) {
+            throw std::invalid_argument("Step must be positive.");
+        }
+        if (n.isNegative() || n == MpInt<bytePrecision>()) {
+            return MpInt<bytePrecision>(1LL);
+        }
+        auto top = getWord(n);
+        auto step = m >= n ? top : getWord(m);
+        auto count = (top - 1) / step + 1;
+        return MpProduct::product<bytePrecision>(std::views::iota(std::uint64_t(0), count) |
+                                                 std::views::transform([top, step](std::uint64_t i) {
+                                                     return top - i * step;
+                                                 }));
+    }
+
+private:
+    /**
+     * @return Absolute value of number fitting one word, throw std::invalid_argument otherwise.
+     */
+    template<std::size_t bytePrecision>
+    static std::uint64_t getWord(const MpInt<bytePrecision> &value) {
+        auto magnitude = value.getMagnitude();
+        if (magnitude.size() > 1) {
+            throw std::invalid_argument("Argument is too large.");
+        }
+        return magnitude.empty() ? 0 : magnitude[0];
+    }
+};
@@ -0,0 +1,129 @@
+#pragma once
+
+#include "MpInt.h"
+#include "MpSeries.h"
+#include <cmath>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+/** Decimal digits of pi per term of Chudnovsky series, log10(640320^3 / 1728) */
+constexpr double CHUDNOVSKY_DIGITS_PER_TERM = 14.181647462725477;
+/** Decimal digits computed beyond requested ones and truncated away, they absorb truncation errors */
+constexpr std::size_t CONSTANT_GUARD_DIGITS = 16;
+
+/**
+ * @brief Mathematical constants to any count of decimal digits, summed by binary splitting (MpSeries). They
+ * exercise multiplication, division and decimal output together, so they also serve as end-to-end benchmark.
+ * Result is exact unless the digits following the requested ones are a run of CONSTANT_GUARD_DIGITS zeros.
+ */
+class MpConstants {
+    // ------------------------------------------------------
+    // ------------------------------------------------------
+    // ------------------ METHODS ---------------------------
+    // ------------------------------------------------------
+    // ------------------------------------------------------
+public:
+    /**
+     * @brief Pi by Chudnovsky series, pi = 426880 sqrt(10005) / S with
+     * S = sum of (13591409 + 545140134 n) (6n)! / ((3n)! (n!)^3 (-640320)^(3n)).
+     * @return Floor of pi * 10^digits.
+     */
+    static MpInt<MP_INT_UNLIMITED> pi(std::size_t digits) {
+        auto scale = getPowerOfTen(digits + CONSTANT_GUARD_DIGITS);
+        auto terms = static_cast<std::uint64_t>(static_cast<double>(digits + CONSTANT_GUARD_DIGITS) /
+                                                CHUDNOVSKY_DIGITS_PER_TERM) + 2;
+        auto [t, q] = MpSeries::sum([](std::uint64_t n) {
+            if (n == 0) {
+                return MpSeriesTerm{Unlimited(13591409LL), Unlimited(1LL), Unlimited(1LL)};
+            }
+            auto k = static_cast<long long>(n);
+            // ratio of consecutive terms without a(n) is -(6n - 5) (2n - 1) (6n - 1) / (n^3 640320^3 / 24)
+            return MpSeriesTerm{Unlimited(13591409LL) + Unlimited(545140134LL) * Unlimited(k),
+                                Unlimited(-(6 * k - 5)) * Unlimited(2 * k - 1) * Unlimited(6 * k - 1),
+                                Unlimited(k) * Unlimited(k) * Unlimited(k) * Unlimited(10939058860032000LL)};
+        }, terms);
+        auto root = (Unlimited(10005LL) * scale * scale).sqrt();
+        return Unlimited(426880LL) * root * q / t / getPowerOfTen(CONSTANT_GUARD_DIGITS);
+    }
+
+    /**
+     * @brief Euler's number as sum of 1 / n!.
+     * @return Floor of e * 10^digits.
+     */
+    static MpInt<MP_INT_UNLIMITED> e(std::size_t digits) {
+        // tail after n terms is below 2 / n!
+        auto target = static_cast<double>(digits + CONSTANT_GUARD_DIGITS) + 1;
+        std::uint64_t terms = 1;
+        for (double logarithm = 0; logarithm <= target; terms++) {
+            logarithm += std::log10(static_cast<double>(terms));
+        }
+        auto [t, q] = MpSeries::sum([](std::uint64_t n) {
+            return MpSeriesTerm{Unlimited(1LL), Unlimited(1LL), Unlimited(static_cast<long long>(std::max<std::uint64_t>(n, 1)))};
+        }, terms);
+        return t * getPowerOfTen(digits) / q;
+    }
+
+    /**
+     * @brief Natural logarithm of 2 by ln 2 = 3/4 sum of (-1)^n (n!)^2 / (2^n (2n + 1)!), each term adds 3 bits.
+     * @return Floor of ln 2 * 10^digits.
+     */
+    static MpInt<MP_INT_UNLIMITED> ln2(std::size_t digits) {
+        auto terms = static_cast<std::uint64_t>(static_cast<double>(digits + CONSTANT_GUARD_DIGITS) *
+                                                std::log2(10.0) / 3) + 2;
+        auto [t, q] = MpSeries::sum([](std::uint64_t n) {
+            if (n == 0) {
+                return MpSeriesTerm{Unlimited(1LL), Unlimited(1LL), Unlimited(1LL)};
+            }
+            auto k = static_cast<long long>(n);
+            return MpSeriesTerm{Unlimited(1LL), Unlimited(-k), Unlimited(4 * (2 * k + 1))};
+        }, terms);
+        return Unlimited(3LL) * t * getPowerOfTen(digits) / (Unlimited(4LL) * q);
+    }
+
+    /**
+     * @brief Decimal expansion of constant. Throw std::invalid_argument for unknown name.
+     * @param name Name of constant: "pi", "e" or "ln2".
+     * @param digits Count of digits after decimal point (truncated).
+     * @return Constant as text, e.g. "3.14" for pi with two digits.
+     */
+    static std::string toDecimal(std::string_view name, std::size_t digits) {
+        Unlimited scaled;
+        if (name == "pi") {
+            scaled = pi(digits);
+        } else if (name == "e") {
+            scaled = e(digits);
+        } else if (name == "ln2") {
+            scaled = ln2(digits);
+        } else {
+            throw std::invalid_argument("Unknown constant.");
+        }
+        auto text = scaled.toDecimal();
+        if (text.length() <= digits) {
+            text.insert(0, digits + 1 - text.length(), '0');
+        }
+        if (digits > 0) {
+            text.insert(text.length() - digits, 1, '.');
+        }
+        return text;
+    }
+
+private:
+    typedef MpInt<MP_INT_UNLIMITED> Unlimited;
+
+    /**
+     * @return 10^exponent by repeated squaring.
+     */
+    static MpInt<MP_INT_UNLIMITED> getPowerOfTen(std::size_t exponent) {
+        Unlimited result(1LL), base(10LL);
+        for (; exponent != 0; exponent >>= 1) {
+            if ((exponent & 1) != 0) {
+                result = result * base;
+            }
+            if (exponent > 1) {
+                base = base * base;
+            }
+        }
+        return result;
+    }
+};
@@ -0,0 +1,384 @@
+#pragma once
+
+#include "MpInt.h"
+#include "MpKernels.h"
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <compare>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+/**
+ * @brief Rounding of results which do not fit the scale of decimal number.
+ */
+enum class MpRoundingMode {
+    /** Toward zero (truncation) */
+    DOWN,
+    /** Away from zero */
+    UP,
+    /** Toward negative infinity */
+    FLOOR,
+    /** Toward positive infinity */
+    CEILING,
+    /** To nearest, ties away from zero */
+    HALF_UP,
+    /** To nearest, ties toward zero */
+    HALF_DOWN,
+    /** To nearest, ties to even last digit (banker's rounding) */
+    HALF_EVEN
+};
+
+/**
+ * @brief Fixed-point decimal number mantissa * 10^(-scale), e.g. money with scale 2. Scale is known at compile
+ * time, so rescaling by up to DECIMAL_CHUNK_DIGITS digits divides by a constant word with precomputed reciprocal
+ * (no runtime division) and larger powers of ten are computed once per scale. Operators round to nearest with
+ * ties to even, named methods take rounding mode. Throw MpIntException if mantissa overflows precision.
+ * @tparam bytePrecision Precision of mantissa in bytes (0 is unlimited).
+ * @tparam scale Count of decimal digits after decimal point.
+ */
+template<std::size_t bytePrecision, std::size_t scale> requires SizeLimitation<bytePrecision>
+class MpDecimal {
+    // ------------------------------------------------------
+    // ------------------------------------------------------
+    // ------------------ VARIABLES -------------------------
+    // ------------------------------------------------------
+    // ------------------------------------------------------
+private:
+    /** Value multiplied by 10^scale */
+    MpInt<bytePrecision> mantissa;
+
+    /** Powers of ten fitting one word, 10^0 to 10^DECIMAL_CHUNK_DIGITS */
+    static constexpr std::array<std::uint64_t, DECIMAL_CHUNK_DIGITS + 1> WORD_POWERS = [] {
+        std::array<std::uint64_t, DECIMAL_CHUNK_DIGITS + 1> powers{};
+        powers[0] = 1;
+        for (std::size_t i = 1; i < powers.size(); i++) {
+            powers[i] = powers[i - 1] * 10;
+        }
+        return powers;
+    }();
+
+    // ------------------------------------------------------
+    // ------------------------------------------------------
+    // ------------------ CONSTRUCTORS ----------------------
+    // ------------------------------------------------------
+    // ------------------------------------------------------
+public:
+    MpDecimal() = default;
+
+    /**
+     * @param integer Integer value.
+     */
+    explicit MpDecimal(const MpInt<bytePrecision> &integer)
+            : mantissa(MpInt<bytePrecision>::fromMagnitude(multiplyByPower<scale>(integer.getMagnitude()),
+                                                           integer.isNegative())) {
+    }
+
+    /**
+     * @param mantissa Value multiplied by 10^scale.
+     * @return Decimal number.
+     */
+    static MpDecimal fromMantissa(const MpInt<bytePrecision> &mantissa) {
+        MpDecimal result;
+        result.mantissa = mantissa;
+        return result;
+    }
+
+    /**
+     * @brief Parse decimal number with optional sign and decimal point, e.g. "-12.345". Digits beyond scale are
+     * rounded. Throw std::invalid_argument on missing or invalid digit.
+     * @param text Number.
+     * @param mode Rounding of digits beyond scale.
+     * @return Decimal number.
+     */
+    static MpDecimal fromString(std::string_view text, MpRoundingMode mode = MpRoundingMode::HALF_EVEN) {
+        auto negative = !text.empty() && text[0] == '-';
+        if (!text.empty() && (text[0] == '-' || text[0] == '+')) {
+            text.remove_prefix(1);
+        }
+        auto point = text.find('.');
+        auto integer = text.substr(0, point);
+        auto fraction = point == std::string_view::npos ? std::string_view() : text.substr(point + 1);
+        if (integer.empty() && fraction.empty()) {
+            throw std::invalid_argument("Missing digits.");
+        }
+        auto isDigit = [](char digit) { return std::isdigit(static_cast<unsigned char>(digit)) != 0; };
+        if (!std::all_of(integer.begin(), integer.end(), isDigit) ||
+            !std::all_of(fraction.begin(), fraction.end(), isDigit)) {
+            throw std::invalid_argument("Invalid digit.");
+        }
+        auto kept = std::min(fraction.size(), scale);
+        std::string digits(integer);
+        digits += fraction.substr(0, kept);
+        digits.append(scale - kept, '0');
+        auto magnitude = MpInt<MP_INT_UNLIMITED>::fromDecimal(digits.empty() ? "0" : digits).getMagnitude();
+        // dropped digits compared with one half of last kept digit
+        auto dropped = fraction.substr(kept);
+        auto rest = !dropped.empty() && dropped.find_first_not_of('0', 1) != std::string_view::npos;
+        auto first = dropped.empty() ? '0' : dropped[0];
+        auto half = first > '5' || (first == '5' && rest) ? 1 : first == '5' ? 0 : -1;
+        if (roundsAway(mode, half, first != '0' || rest, magnitude, negative)) {
+            increment(magnitude);
+        }
+        return fromMantissa(MpInt<bytePrecision>::fromMagnitude(std::move(magnitude), negative));
+    }
+
+    // ------------------------------------------------------
+    // ------------------------------------------------------
+    // ------------------ METHODS ---------------------------
+    // ------------------------------------------------------
+    // ------------------------------------------------------
+public:
+    /**
+     * @return Value multiplied by 10^scale.
+     */
+    [[nodiscard]] const MpInt<bytePrecision> &getMantissa() const {
+        return mantissa;
+    }
+
+    [[nodiscard]] bool isNegative() const {
+        return mantissa.isNegative();
+    }
+
+    /**
+     * @return Decimal text with exactly scale digits after decimal point, e.g. "-0.50" for scale 2.
+     */
+    [[nodiscard]] std::string toString() const {
+        auto text = mantissa.toDecimal();
+        auto negative = text.starts_with('-');
+        if (negative) {
+            text.erase(0, 1);
+        }
+        if constexpr (scale > 0) {
+            if (text.length() <= scale) {
+                text.insert(0, scale + 1 - text.length(), '0');
+            }
+            text.insert(text.length() - scale, 1, '.');
+        }
+        return negative ? '-' + text : text;
+    }
+
+    /**
+     * @brief Convert to other scale, rounding if digits are dropped.
+     * @tparam otherScale Scale of result.
+     * @param mode Rounding of dropped digits.
+     * @return Rescaled number.
+     */
+    template<std::size_t otherScale>
+    [[nodiscard]] MpDecimal<bytePrecision, otherScale>
+    rescale(MpRoundingMode mode = MpRoundingMode::HALF_EVEN) const {
+        auto magnitude = mantissa.getMagnitude();
+        if constexpr (otherScale >= scale) {
+            magnitude = multiplyByPower<otherScale - scale>(magnitude);
+        } else {
+            magnitude = divideByPower<scale - otherScale>(magnitude, isNegative(), mode);
+        }
+        return MpDecimal<bytePrecision, otherScale>::fromMantissa(
+                MpInt<bytePrecision>::fromMagnitude(std::move(magnitude), isNegative()));
+    }
+
+    /**
+     * @brief Product rescaled in one step: mantissa of a * b is a.mantissa * b.mantissa / 10^scale, rounded.
+     * @return a * b.
+     */
+    static MpDecimal multiply(const MpDecimal &a, const MpDecimal &b, MpRoundingMode mode) {
+        auto negative = a.isNegative() != b.isNegative();
+        auto product = MpInt<MP_INT_UNLIMITED>::multiplyMagnitudes(a.mantissa.getMagnitude(),
+                                                                  b.mantissa.getMagnitude());
+        return fromMantissa(MpInt<bytePrecision>::fromMagnitude(divideByPower<scale>(product, negative, mode),
+                                                                negative));
+    }
+
+    /**
+     * @brief Quotient with mantissa a.mantissa * 10^scale / b.mantissa, rounded. Throw MpIntException if b is zero.
+     * @return a / b.
+     */
+    static MpDecimal divide(const MpDecimal &a, const MpDecimal &b, MpRoundingMode mode) {
+        auto divisor = b.mantissa.getMagnitude();
+        if (divisor.empty()) {
+            throw MpIntException<MpInt<MP_INT_UNLIMITED>>(MpInt<MP_INT_UNLIMITED>(0LL));
+        }
+        auto negative = a.isNegative() != b.isNegative();
+        auto dividend = multiplyByPower<scale>(a.mantissa.getMagnitude());
+        return fromMantissa(MpInt<bytePrecision>::fromMagnitude(divideRounded(dividend, divisor, negative, mode),
+                                                                negative));
+    }
+
+private:
+    /**
+     * @return Magnitude multiplied by 10^digits.
+     */
+    template<std::size_t digits>
+    static magnitudeStorage multiplyByPower(const magnitudeStorage &magnitude) {
+        if constexpr (digits == 0) {
+            return magnitude;
+        } else if constexpr (digits <= DECIMAL_CHUNK_DIGITS) {
+            magnitudeStorage product(magnitude.size() + 1);
+            product.back() = MpKernels::mul1(product.data(), magnitude.data(), magnitude.size(),
+                                             WORD_POWERS[digits]);
+            if (product.back() == 0) {
+                product.pop_back();
+            }
+            return product;
+        } else {
+            return MpInt<MP_INT_UNLIMITED>::multiplyMagnitudes(magnitude, getPower<digits>());
+        }
+    }
+
+    /**
+     * @brief Divide magnitude by 10^digits, rounding quotient.
+     * @param negative Sign of rounded value.
+     * @return Rounded quotient.
+     */
+    template<std::size_t digits>
+    static magnitudeStorage divideByPower(const magnitudeStorage &magnitude, bool negative, MpRoundingMode mode) {
+        if constexpr (digits == 0) {
+            return magnitude;
+        } else if constexpr (digits <= DECIMAL_CHUNK_DIGITS) {
+            static constexpr MpKernels::Divisor divisor(WORD_POWERS[digits]);
+            magnitudeStorage quotient(magnitude.size());
+            auto remainder = MpKernels::divRem1(quotient.data(), magnitude.data(), magnitude.size(), divisor);
+            auto complement = divisor.get() - remainder;
+            auto half = remainder > complement ? 1 : remainder == complement ? 0 : -1;
+            MpInt<MP_INT_UNLIMITED>::trimMagnitude(quotient);
+            if (roundsAway(mode, half, remainder != 0, quotient, negative)) {
+                increment(quotient);
+            }
+            return quotient;
+        } else {
+            return divideRounded(magnitude, getPower<digits>(), negative, mode);
+        }
+    }
+
+    /**
+     * @brief Divide magnitudes, rounding quotient.
+     * @param divisor Nonzero divisor.
+     * @param negative Sign of rounded value.
+     * @return Rounded quotient.
+     */
+    static magnitudeStorage divideRounded(const magnitudeStorage &dividend, const magnitudeStorage &divisor,
+                                          bool negative, MpRoundingMode mode) {
+        magnitudeStorage quotient;
+        magnitudeStorage remainder;
+        if (MpInt<MP_INT_UNLIMITED>::compareMagnitudes(dividend, divisor) < 0) {
+            remainder = dividend;
+        } else if (divisor.size() == 1) {
+            quotient.resize(dividend.size());
+            remainder = {MpKernels::divRem1(quotient.data(), dividend.data(), dividend.size(), divisor[0])};
+        } else {
+            quotient.resize(dividend.size() - divisor.size() + 1);
+            remainder.resize(divisor.size());
+            MpKernels::divRem(quotient.data(), remainder.data(), dividend.data(), dividend.size(), divisor.data(),
+                              divisor.size());
+        }
+        MpInt<MP_INT_UNLIMITED>::trimMagnitude(quotient);
+        MpInt<MP_INT_UNLIMITED>::trimMagnitude(remainder);
+        auto inexact = !remainder.empty();
+        auto half = MpInt<MP_INT_UNLIMITED>::compareMagnitudes(
+                MpInt<MP_INT_UNLIMITED>::shiftLeftMagnitude(remainder, 1), divisor);
+        if (roundsAway(mode, half, inexact, quotient, negative)) {
+            increment(quotient);
+        }
+        return quotient;
+    }
+
+    /**
+     * @return Magnitude of 10^digits, computed on first use.
+     */
+    template<std::size_t digits>
+    static const magnitudeStorage &getPower() {
+        static const magnitudeStorage power = [] {
+            magnitudeStorage result{WORD_POWERS[digits % DECIMAL_CHUNK_DIGITS]};
+            for (std::size_t i = 0; i < digits / DECIMAL_CHUNK_DIGITS; i++) {
+                result.push_back(MpKernels::mul1(result.data(), result.data(), result.size(),
+                                                 WORD_POWERS[DECIMAL_CHUNK_DIGITS]));
+            }
+            MpInt<MP_INT_UNLIMITED>::trimMagnitude(result);
+            return result;
+        }();
+        return power;
+    }
+
+    /**
+     * @brief Decide if truncated quotient is rounded away from zero.
+     * @param half Comparison of remainder with half of divisor (negative, zero or positive).
+     * @param inexact True if remainder is nonzero.
+     * @param quotient Truncated quotient, its parity decides ties of HALF_EVEN.
+     * @param negative Sign of rounded value.
+     */
+    static bool roundsAway(MpRoundingMode mode, int half, bool inexact, const magnitudeStorage &quotient,
+                           bool negative) {
+        switch (mode) {
+            case MpRoundingMode::DOWN:
+                return false;
+            case MpRoundingMode::UP:
+                return inexact;
+            case MpRoundingMode::FLOOR:
+                return inexact && negative;
+            case MpRoundingMode::CEILING:
+                return inexact && !negative;
+            case MpRoundingMode::HALF_UP:
+                return half >= 0 && inexact;
+            case MpRoundingMode::HALF_DOWN:
+                return half > 0;
+            case MpRoundingMode::HALF_EVEN:
+                return half > 0 || (half == 0 && inexact && !quotient.empty() && (quotient[0] & 1) != 0);
+        }
+        return false;
+    }
+
+    /**
+     * @brief Add one to magnitude.
+     */
+    static void increment(magnitudeStorage &magnitude) {
+        magnitude.push_back(0);
+        MpKernels::add1(magnitude.data(), magnitude.data(), magnitude.size(), 1);
+        MpInt<MP_INT_UNLIMITED>::trimMagnitude(magnitude);
+    }
+
+    // ------------------------------------------------------
+    // ------------------------------------------------------
+    // ------------------ OPERATORS -------------------------
+    // ------------------------------------------------------
+    // ------------------------------------------------------
+public:
+    friend MpDecimal operator+(const MpDecimal &a, const MpDecimal &b) {
+        return fromMantissa(a.mantissa + b.mantissa);
+    }
+
+    friend MpDecimal operator-(const MpDecimal &a, const MpDecimal &b) {
+        return fromMantissa(a.mantissa - b.mantissa);
+    }
+
+    friend MpDecimal operator-(const MpDecimal &a) {
+        return fromMantissa(MpInt<bytePrecision>(0LL) - a.mantissa);
+    }
+
+    /**
+     * @return a * b rounded to nearest, ties to even.
+     */
+    friend MpDecimal operator*(const MpDecimal &a, const MpDecimal &b) {
+        return multiply(a, b, MpRoundingMode::HALF_EVEN);
+    }
+
+    /**
+     * @return a / b rounded to nearest, ties to even.
+     */
+    friend MpDecimal operator/(const MpDecimal &a, const MpDecimal &b) {
+        return divide(a, b, MpRoundingMode::HALF_EVEN);
+    }
+
+    friend bool operator==(const MpDecimal &a, const MpDecimal &b) {
+        return a.mantissa == b.mantissa;
+    }
+
+    friend std::strong_ordering operator<=>(const MpDecimal &a, const MpDecimal &b) {
+        return a.mantissa <=> b.mantissa;
+    }
+
+    friend std::ostream &operator<<(std::ostream &stream, const MpDecimal &value) {
+        return stream << value.toString();
+    }
+};
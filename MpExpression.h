@@ -0,0 +1,462 @@
+#pragma once
+
+#include <algorithm>
+#include <cctype>
+#include <cstddef>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * @brief Maximal height of expression tree (and nesting of parentheses), keeps evaluation recursion bounded.
+ */
+constexpr std::size_t MAX_EXPRESSION_DEPTH = 1000;
+
+/**
+ * @brief Type of token of terminal expression.
+ */
+enum class MpTokenType {
+    NUMBER,
+    BANK,
+    IDENTIFIER,
+    OPERATOR,
+    LEFT_PARENTHESIS,
+    RIGHT_PARENTHESIS,
+    COMMA,
+    END,
+    INVALID
+};
+
+/**
+ * @brief Token of terminal expression. Text points into parsed input.
+ */
+struct MpToken {
+    /** Type of token */
+    MpTokenType type;
+    /** Digits of number or bank index, letters of function name, operator character otherwise */
+    std::string_view text;
+};
+
+/**
+ * @brief Tokenizer of terminal expressions - numbers, bank references ($n), function names, operators, parentheses
+ * and commas.
+ */
+class MpTokenizer {
+private:
+    /** Tokenized input */
+    std::string_view input;
+    /** Position of next unread character */
+    std::size_t position = 0;
+    /** Token returned by next call of next() */
+    MpToken current{MpTokenType::END, {}};
+
+public:
+    explicit MpTokenizer(std::string_view input) : input(input) {
+        current = read();
+    }
+
+    /**
+     * @return Next token without consuming it.
+     */
+    [[nodiscard]] const MpToken &peek() const {
+        return current;
+    }
+
+    /**
+     * @return Next token.
+     */
+    MpToken next() {
+        auto token = current;
+        current = read();
+        return token;
+    }
+
+private:
+    /**
+     * @return Length of digit sequence starting at from.
+     */
+    [[nodiscard]] std::size_t digitsLength(std::size_t from) const {
+        auto end = from;
+        while (end < input.length() && std::isdigit(static_cast<unsigned char>(input[end]))) {
+            end++;
+        }
+        return end - from;
+    }
+
+    /**
+     * @brief Read token from input.
+     */
+    MpToken read() {
+        while (position < input.length() && std::isspace(static_cast<unsigned char>(input[position]))) {
+            position++;
+        }
+        if (position == input.length()) {
+            return {MpTokenType::END, {}};
+        }
+        char character = input[position];
+        if (std::isdigit(static_cast<unsigned char>(character))) {
+            auto length = digitsLength(position);
+            position += length;
+            return {MpTokenType::NUMBER, input.substr(position - length, length)};
+        }
+        if (character == '$') {
+            auto length = digitsLength(position + 1);
+            position += length + 1;
+            return {length == 0 ? MpTokenType::INVALID : MpTokenType::BANK, input.substr(position - length, length)};
+        }
+        if (std::isalpha(static_cast<unsigned char>(character))) {
+            auto end = position;
+            while (end < input.length() && std::isalpha(static_cast<unsigned char>(input[end]))) {
+                end++;
+            }
+            auto text = input.substr(position, end - position);
+            position = end;
+            return {MpTokenType::IDENTIFIER, text};
+        }
+        auto text = input.substr(position++, 1);
+        switch (character) {
+            case '+':
+            case '-':
+            case '*':
+            case '/':
+            case '!':
+                return {MpTokenType::OPERATOR, text};
+            case '(':
+                return {MpTokenType::LEFT_PARENTHESIS, text};
+            case ')':
+                return {MpTokenType::RIGHT_PARENTHESIS, text};
+            case ',':
+                return {MpTokenType::COMMA, text};
+            default:
+                return {MpTokenType::INVALID, text};
+        }
+    }
+};
+
+/**
+ * @brief Type of node of expression tree.
+ */
+enum class MpExpressionType {
+    LITERAL,
+    BANK,
+    UNARY,
+    BINARY,
+    FUNCTION
+};
+
+/**
+ * @brief Node of expression tree. Unary nodes ('-' negation, '!' factorial) have one operand, function nodes any count
+ * of arguments. Binary node is a left-associative chain x0 o1 x1 o2 x2 ... = ((x0 o1 x1) o2 x2) ..., so that long
+ * sums and products are flat and evaluated iteratively.
+ */
+class MpExpression {
+private:
+    /** Type of node */
+    MpExpressionType type;
+    /** Operator of unary node */
+    char oper = '\0';
+    /** Operators of binary chain, operator i joins operands i and i + 1 */
+    std::string operators;
+    /** Decimal digits (with optional leading '-') of literal or name of function */
+    std::string literal;
+    /** One-based index of bank item */
+    std::size_t bankIndex = 0;
+    /** Operands of operator */
+    std::vector<MpExpression> operands;
+    /** Height of tree rooted in this node */
+    std::size_t height = 1;
+    /** True if tree rooted in this node references bank */
+    bool bankReference = false;
+
+public:
+    /**
+     * @param literal Decimal digits.
+     * @return Literal node.
+     */
+    static MpExpression makeLiteral(std::string_view literal) {
+        MpExpression expression(MpExpressionType::LITERAL);
+        expression.literal = literal;
+        return expression;
+    }
+
+    /**
+     * @param index One-based index of bank item.
+     * @return Bank reference node.
+     */
+    static MpExpression makeBank(std::size_t index) {
+        MpExpression expression(MpExpressionType::BANK);
+        expression.bankIndex = index;
+        expression.bankReference = true;
+        return expression;
+    }
+
+    /**
+     * @return Unary operator node.
+     */
+    static MpExpression makeUnary(char oper, MpExpression &&operand) {
+        MpExpression expression(MpExpressionType::UNARY);
+        expression.oper = oper;
+        expression.height = operand.height + 1;
+        expression.bankReference = operand.bankReference;
+        expression.operands.push_back(std::move(operand));
+        return expression;
+    }
+
+    /**
+     * @return Binary node of left oper right, chain of left is extended if left is binary node.
+     */
+    static MpExpression makeBinary(char oper, MpExpression &&left, MpExpression &&right) {
+        if (left.type != MpExpressionType::BINARY) {
+            MpExpression expression(MpExpressionType::BINARY);
+            expression.height = left.height + 1;
+            expression.bankReference = left.bankReference;
+            expression.operands.push_back(std::move(left));
+            return makeBinary(oper, std::move(expression), std::move(right));
+        }
+        left.operators.push_back(oper);
+        left.height = std::max(left.height, right.height + 1);
+        left.bankReference = left.bankReference || right.bankReference;
+        left.operands.push_back(std::move(right));
+        return std::move(left);
+    }
+
+    /**
+     * @param name Name of function, it is not checked by parser.
+     * @return Function call node.
+     */
+    static MpExpression makeFunction(std::string_view name, std::vector<MpExpression> &&arguments) {
+        MpExpression expression(MpExpressionType::FUNCTION);
+        expression.literal = name;
+        for (const auto &argument: arguments) {
+            expression.height = std::max(expression.height, argument.height + 1);
+            expression.bankReference = expression.bankReference || argument.bankReference;
+        }
+        expression.operands = std::move(arguments);
+        return expression;
+    }
+
+    [[nodiscard]] MpExpressionType getType() const {
+        return type;
+    }
+
+    [[nodiscard]] char getOperator() const {
+        return oper;
+    }
+
+    [[nodiscard]] const std::string &getOperators() const {
+        return operators;
+    }
+
+    [[nodiscard]] const std::string &getLiteral() const {
+        return literal;
+    }
+
+    [[nodiscard]] const std::string &getName() const {
+        return literal;
+    }
+
+    [[nodiscard]] std::size_t getBankIndex() const {
+        return bankIndex;
+    }
+
+    [[nodiscard]] const std::vector<MpExpression> &getOperands() const {
+        return operands;
+    }
+
+    [[nodiscard]] std::size_t getHeight() const {
+        return height;
+    }
+
+    /**
+     * @return True if result depends on bank content.
+     */
+    [[nodiscard]] bool hasBankReference() const {
+        return bankReference;
+    }
+
+    /**
+     * @brief Negate literal in place. Used so that "-N" is parsed as one literal and fits bounded minimum.
+     */
+    void negateLiteral() {
+        literal = literal.starts_with('-') ? literal.substr(1) : '-' + literal;
+    }
+
+private:
+    explicit MpExpression(MpExpressionType type) : type(type) {
+    }
+};
+
+/**
+ * @brief Precedence climbing parser of terminal expressions.
+ *
+ * Grammar (binary operators are left associative, '*' and '/' bind tighter than '+' and '-'):
+ *   expression := unary (('+' | '-' | '*' | '/') unary)*
+ *   unary      := '-' unary | postfix
+ *   postfix    := primary '!'*
+ *   primary    := NUMBER | '$' NUMBER | '(' expression ')' | NAME '(' expression (',' expression)* ')'
+ */
+class MpParser {
+private:
+    /** Source of tokens */
+    MpTokenizer tokenizer;
+    /** Current nesting depth */
+    std::size_t depth = 0;
+    /** False after first syntax error */
+    bool valid = true;
+
+public:
+    /**
+     * @brief Parse expression.
+     * @param input Terminal input.
+     * @return Expression tree or "nullopt" on syntax error.
+     */
+    static std::optional<MpExpression> parse(std::string_view input) {
+        MpParser parser(input);
+        auto expression = parser.parseExpression(0);
+        if (!parser.valid || parser.tokenizer.peek().type != MpTokenType::END) {
+            return std::nullopt;
+        }
+        return expression;
+    }
+
+private:
+    explicit MpParser(std::string_view input) : tokenizer(input) {
+    }
+
+    /**
+     * @return Precedence of binary operator or 0 if token is not binary operator.
+     */
+    static int precedence(const MpToken &token) {
+        if (token.type != MpTokenType::OPERATOR) {
+            return 0;
+        }
+        switch (token.text[0]) {
+            case '+':
+            case '-':
+                return 1;
+            case '*':
+            case '/':
+                return 2;
+            default:
+                return 0;
+        }
+    }
+
+    /**
+     * @brief Mark expression invalid and return placeholder node.
+     */
+    MpExpression fail() {
+        valid = false;
+        return MpExpression::makeLiteral("0");
+    }
+
+    /**
+     * @brief Parse binary operators with precedence higher than minPrecedence.
+     */
+    MpExpression parseExpression(int minPrecedence) {
+        auto left = parseUnary();
+        while (valid && precedence(tokenizer.peek()) > minPrecedence) {
+            auto oper = tokenizer.next();
+            auto right = parseExpression(precedence(oper));
+            left = MpExpression::makeBinary(oper.text[0], std::move(left), std::move(right));
+            if (left.getHeight() > MAX_EXPRESSION_DEPTH) {
+                return fail();
+            }
+        }
+        return left;
+    }
+
+    /**
+     * @brief Parse prefix negation.
+     */
+    MpExpression parseUnary() {
+        const auto &token = tokenizer.peek();
+        if (token.type != MpTokenType::OPERATOR || token.text[0] != '-') {
+            return parsePostfix();
+        }
+        if (++depth > MAX_EXPRESSION_DEPTH) {
+            return fail();
+        }
+        tokenizer.next();
+        auto operand = parseUnary();
+        depth--;
+        if (operand.getType() == MpExpressionType::LITERAL) {
+            operand.negateLiteral();
+            return operand;
+        }
+        return MpExpression::makeUnary('-', std::move(operand));
+    }
+
+    /**
+     * @brief Parse postfix factorial.
+     */
+    MpExpression parsePostfix() {
+        auto operand = parsePrimary();
+        while (valid && tokenizer.peek().type == MpTokenType::OPERATOR && tokenizer.peek().text[0] == '!') {
+            tokenizer.next();
+            operand = MpExpression::makeUnary('!', std::move(operand));
+            if (operand.getHeight() > MAX_EXPRESSION_DEPTH) {
+                return fail();
+            }
+        }
+        return operand;
+    }
+
+    /**
+     * @brief Parse number, bank reference, parenthesized expression or function call.
+     */
+    MpExpression parsePrimary() {
+        auto token = tokenizer.next();
+        switch (token.type) {
+            case MpTokenType::NUMBER:
+                return MpExpression::makeLiteral(token.text);
+            case MpTokenType::BANK: {
+                std::size_t index = 0;
+                for (char digit: token.text) {
+                    index = index * 10 + (digit - '0');
+                    if (index > MAX_BANK_REFERENCE) {
+                        return fail();
+                    }
+                }
+                return MpExpression::makeBank(index);
+            }
+            case MpTokenType::LEFT_PARENTHESIS: {
+                if (++depth > MAX_EXPRESSION_DEPTH) {
+                    return fail();
+                }
+                auto expression = parseExpression(0);
+                depth--;
+                if (tokenizer.next().type != MpTokenType::RIGHT_PARENTHESIS) {
+                    return fail();
+                }
+                return expression;
+            }
+            case MpTokenType::IDENTIFIER: {
+                if (tokenizer.next().type != MpTokenType::LEFT_PARENTHESIS || ++depth > MAX_EXPRESSION_DEPTH) {
+                    return fail();
+                }
+                std::vector<MpExpression> arguments;
+                arguments.push_back(parseExpression(0));
+                while (valid && tokenizer.peek().type == MpTokenType::COMMA) {
+                    tokenizer.next();
+                    arguments.push_back(parseExpression(0));
+                }
+                depth--;
+                if (tokenizer.next().type != MpTokenType::RIGHT_PARENTHESIS) {
+                    return fail();
+                }
+                auto function = MpExpression::makeFunction(token.text, std::move(arguments));
+                if (function.getHeight() > MAX_EXPRESSION_DEPTH) {
+                    return fail();
+                }
+                return function;
+            }
+            default:
+                return fail();
+        }
+    }
+
+    /** Bank references above this index are rejected before they overflow */
+    static constexpr std::size_t MAX_BANK_REFERENCE = 1'000'000'000;
+};
@@ -0,0 +1,7 @@
+#include "MpInt.h"
+
+template class MpInt<MP_INT_UNLIMITED>;
+template class MpInt<4>;
+template class MpInt<8>;
+template class MpInt<16>;
+template class MpInt<32>;
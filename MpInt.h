@@ -1,11 +1,28 @@
 #pragma once
 
 #include <iostream>
-#include <bitset>
+#include <cstdint>
 #include <cmath>
 #include <sstream>
 #include <vector>
 #include <algorithm>
+#include <array>
+#include <bit>
+#include <compare>
+#include <random>
+#include <stdexcept>
+#include <string_view>
+#include <version>
+#include "MpKernels.h"
+#include "MpProgress.h"
+#include "MpStats.h"
+#include "MpStorage.h"
+
+#if __has_include(<format>)
+
+#include <format>
+
+#endif
 
 /** Template argument for unlimited number precision */
 constexpr std::size_t MP_INT_UNLIMITED = 0;
@@ -19,6 +36,38 @@ template<std::size_t bytePrecision> concept SizeLimitation = (bytePrecision >= M
 typedef std::int64_t bitsetItem;
 /** Bit size of one element of bitset */
 constexpr std::size_t ELEMENT_BIT_SIZE = sizeof(bitsetItem) * 8;
+/** Storage of bitset items, memory-mapped for huge numbers (see MpStorage) */
+typedef std::vector<bitsetItem, MpAllocator<bitsetItem>> bitsetStorage;
+/** Storage of unsigned magnitude words used by conversions */
+typedef std::vector<std::uint64_t, MpAllocator<std::uint64_t>> magnitudeStorage;
+/** Largest power of ten fitting into one magnitude word */
+constexpr std::uint64_t DECIMAL_CHUNK = 10000000000000000000ULL;
+/** Count of decimal digits of DECIMAL_CHUNK - 1 */
+constexpr std::size_t DECIMAL_CHUNK_DIGITS = 19;
+/** DECIMAL_CHUNK with precomputed reciprocal, decimal output divides by it without division instructions */
+constexpr MpKernels::Divisor DECIMAL_CHUNK_DIVISOR{DECIMAL_CHUNK};
+/** Size of text block handed over to output sinks */
+constexpr std::size_t OUTPUT_BLOCK_SIZE = 4096;
+/** Largest bit length of overflowed result computed exactly for MpIntException */
+constexpr std::size_t OVERFLOW_VALUE_BITS = 65536;
+/** Largest predicted bit length of result preallocated up front (16 MiB), larger results grow as computed */
+constexpr std::size_t PREALLOCATION_MAX_BITS = std::size_t{1} << 27;
+/** Largest supported count of bits per digit in power-of-two radix conversions (base 32) */
+constexpr unsigned MAX_RADIX_BITS = 5;
+/** Digits of power-of-two radixes up to base 32 */
+constexpr char RADIX_DIGITS_LOWER[] = "0123456789abcdefghijklmnopqrstuv";
+/** Upper case digits of power-of-two radixes up to base 32 */
+constexpr char RADIX_DIGITS_UPPER[] = "0123456789ABCDEFGHIJKLMNOPQRSTUV";
+/** Value of digit character in power-of-two radixes, 0xFF for invalid characters */
+constexpr std::array<std::uint8_t, 256> RADIX_DIGIT_VALUES = [] {
+    std::array<std::uint8_t, 256> values{};
+    values.fill(0xFF);
+    for (std::uint8_t i = 0; i < 32; i++) {
+        values[static_cast<unsigned char>(RADIX_DIGITS_LOWER[i])] = i;
+        values[static_cast<unsigned char>(RADIX_DIGITS_UPPER[i])] = i;
+    }
+    return values;
+}();
 
 /**
  * @brief Exception thrown from inside of MpInt arithmetic operations. It is thrown usually on overflow.
@@ -33,6 +82,25 @@ public:
     }
 };
 
+/**
+ * @brief Exception thrown instead of MpIntException when overflow is certain from predicted size of result and the
+ * overflowed value would be too large to compute (more than OVERFLOW_VALUE_BITS bits).
+ */
+class MpIntOverflowPredicted : public std::exception {
+public:
+    /** Lower bound of bit length of magnitude of result */
+    const std::size_t bits;
+    /** Precision of result in bits */
+    const std::size_t precision;
+
+    MpIntOverflowPredicted(std::size_t bits, std::size_t precision) : bits(bits), precision(precision) {
+    }
+
+    [[nodiscard]] const char *what() const noexcept override {
+        return "Predicted overflow.";
+    }
+};
+
 
 /**
  * @brief Class representing dynamic precision number.
@@ -63,10 +131,33 @@ private:
     // ------------------------------------------------------
 private:
     /** Vector representing bits of number */
-    std::vector<bitsetItem> bitset;
+    bitsetStorage bitset;
     /** Bool representing number positivity/negativity. */
     bool negative = false;
 
+    /** Numbers of other precisions may build results directly */
+    template<std::size_t otherBytePrecision> requires SizeLimitation<otherBytePrecision>
+    friend class MpInt;
+
+    /** Accumulator reads limbs directly */
+    friend class MpAccumulator;
+
+    /** Product tree multiplies magnitudes directly */
+    friend class MpProduct;
+
+    /** Primality tests work on magnitudes directly */
+    friend class MpPrime;
+
+    /** Combinatorial functions predict overflow and build results from magnitudes */
+    friend class MpCombinatorics;
+
+    /** Residue number system reduces and reconstructs magnitudes directly */
+    friend class MpRns;
+
+    /** Decimal numbers rescale magnitudes directly */
+    template<std::size_t otherBytePrecision, std::size_t scale> requires SizeLimitation<otherBytePrecision>
+    friend class MpDecimal;
+
     // ------------------------------------------------------
     // ------------------------------------------------------
     // ------------------ CONSTRUCTORS ----------------------
@@ -96,30 +187,37 @@ public:
     }
 
     /** Value assign */
-    explicit MpInt(long long in) {
-        this->negative = in < 0;
-        std::bitset<sizeof(long long) * 8> bits(in);
-        for (auto i = 0; i < sizeof(long long) * 8; i++) this->setBit(i, bits[i]);
-    }
+    explicit MpInt(long long in) : bitset{static_cast<bitsetItem>(in)}, negative(in < 0) {}
 
-    /** Other size constructor */
+    /**
+     * Other size constructor. Limbs are copied as they are, sign extension is given by negative flag, so the value is
+     * kept (it is not checked against precision of this).
+     */
     template<size_t otherBytePrecision>
     requires SizeLimitation<otherBytePrecision>
-    explicit MpInt(const MpInt<otherBytePrecision> &other) noexcept {
-        this->negative = other.isNegative();
-        for (auto i = 0; i < other.getCurrentCapacity(); i++) {
-            this->setBit(i, other.getBit(i));
-        }
-    }
+    explicit MpInt(const MpInt<otherBytePrecision> &other) noexcept: bitset(other.bitset), negative(other.negative) {}
+
+    /** Other size move constructor, adopts limbs of other */
+    template<size_t otherBytePrecision>
+    requires SizeLimitation<otherBytePrecision>
+    explicit MpInt(MpInt<otherBytePrecision> &&other) noexcept: bitset(std::move(other.bitset)),
+                                                                 negative(other.negative) {}
 
     /** Other size assign */
     template<size_t otherBytePrecision>
     requires SizeLimitation<otherBytePrecision>
     MpInt &operator=(const MpInt<otherBytePrecision> &other) noexcept {
-        this->negative = other.isNegative();
-        for (auto i = 0; i < other.getCurrentCapacity(); i++) {
-            this->setBit(i, other.getBit(i));
-        }
+        this->bitset = other.bitset;
+        this->negative = other.negative;
+        return *this;
+    }
+
+    /** Other size move assign, adopts limbs of other */
+    template<size_t otherBytePrecision>
+    requires SizeLimitation<otherBytePrecision>
+    MpInt &operator=(MpInt<otherBytePrecision> &&other) noexcept {
+        this->bitset = std::move(other.bitset);
+        this->negative = other.negative;
         return *this;
     }
 
@@ -183,31 +281,38 @@ public:
      * @return Copy of this.
      */
     [[nodiscard]] MpInt copy() const {
-        MpInt result;
-        for (int i = 0; i < this->getCurrentCapacity(); i++) {
-            result.setBit(i, this->getBit(i));
-        }
-        result.negative = this->negative;
-        return result;
+        return *this;
     }
 
     /**
      * @return Absolute value of this.
      */
     [[nodiscard]] inline MpInt abs() const {
-        auto copy = this->copy();
-        if (copy.isNegative()) {
-            copy.secondComplementReverse();
+        if (!this->isNegative()) {
+            return *this;
+        }
+        auto magnitude = this->getMagnitude();
+        MpInt result;
+        result.bitset.assign(magnitude.begin(), magnitude.end());
+        return result;
+    }
+
+    /**
+     * @brief Integer square root. Throw std::invalid_argument if this is negative.
+     * @return Floor of square root of this.
+     */
+    [[nodiscard]] MpInt sqrt() const {
+        if (this->isNegative()) {
+            throw std::invalid_argument("Negative argument.");
         }
-        copy.negative = false;
-        return copy;
+        return fromMagnitude(sqrtMagnitude(this->getMagnitude()), false);
     }
 
     /**
      * @brief Reset number to 0.
      */
     void reset() {
-        this->bitset = std::vector<bitsetItem>();
+        this->bitset = bitsetStorage();
         this->setNegative(false);
     }
 
@@ -248,16 +353,63 @@ public:
      * @return Computed number.
      */
     [[nodiscard]] MpInt<bytePrecision> factorial() const {
-        MpInt<MP_INT_UNLIMITED> result(1LL);
-        MpInt<MP_INT_UNLIMITED> i(2LL);
-        for (; i <= *this; i = i + MpInt<4>(1LL)) {
-            result = result * i;
-        }
-        if (this->bitPrecision != MP_INT_UNLIMITED &&
-            static_cast<long long>(bitPrecision) < result.getTopBit()) {
-            throw MpIntException<MpInt<MP_INT_UNLIMITED>>(result);
+        MpInt<MP_INT_UNLIMITED> known(1LL);
+        MpInt<MP_INT_UNLIMITED> knownFactorial(1LL);
+        return this->factorial(known, knownFactorial);
+    }
+
+    /**
+     * @brief Compute factorial from this, continuing from already computed factorial of smaller number.
+     * @param known Number k whose factorial is known (1 <= k). Set to this if this is greater.
+     * @param knownFactorial Factorial of k. Set to factorial of this (in unlimited precision) if this is greater,
+     * even if MpIntException is thrown. Throw MpIntOverflowPredicted before any work if predicted bit length
+     * certainly overflows and is larger than OVERFLOW_VALUE_BITS.
+     * @return Computed number.
+     */
+    [[nodiscard]] MpInt<bytePrecision> factorial(MpInt<MP_INT_UNLIMITED> &known,
+                                                 MpInt<MP_INT_UNLIMITED> &knownFactorial) const {
+        MpStats::Timer timer(MpStatsOperation::FACTORIAL, this->getCurrentCapacity());
+        MpProgress::Scope progress("faktorial");
+        auto first = known.getSmallValue();
+        auto last = this->getSmallValue();
+        if (*this > known && first != 0 && last != 0) {
+            auto [minimalBits, maximalBits] = predictFactorialBits(last);
+            checkPredictedOverflow(minimalBits);
+            // multiply in place by products of consecutive numbers fitting one word
+            auto words = knownFactorial.getMagnitude();
+            if (maximalBits <= PREALLOCATION_MAX_BITS) {
+                words.reserve(maximalBits / ELEMENT_BIT_SIZE + 2);
+            }
+            auto next = first + 1;
+            try {
+                while (next <= last) {
+                    MpProgress::checkpoint();
+                    unsigned __int128 multiplier = next++;
+                    while (next <= last && ((multiplier * next) >> 64) == 0) {
+                        multiplier *= next++;
+                    }
+                    auto carry = MpKernels::mul1(words.data(), words.data(), words.size(),
+                                                 static_cast<std::uint64_t>(multiplier));
+                    if (carry != 0) {
+                        words.push_back(carry);
+                    }
+                    progress.report(next - 1 - first, last - first);
+                }
+            } catch (...) {
+                known = MpInt<MP_INT_UNLIMITED>::fromMagnitude(magnitudeStorage{next - 1}, false);
+                knownFactorial = MpInt<MP_INT_UNLIMITED>::fromMagnitude(std::move(words), false);
+                throw;
+            }
+            known = *this;
+            knownFactorial = MpInt<MP_INT_UNLIMITED>::fromMagnitude(std::move(words), false);
+        } else {
+            // numbers not fitting one word
+            for (auto i = known + MpInt<4>(1LL); i <= *this; i = i + MpInt<4>(1LL)) {
+                knownFactorial = knownFactorial * i;
+                known = i;
+            }
         }
-        return MpInt<bytePrecision>(result);
+        return fromTwosComplement(bitsetStorage(knownFactorial.bitset), false);
     }
 
 
@@ -295,6 +447,429 @@ private:
         }
     }
 
+    /**
+     * @return Absolute value of this as unsigned words without leading zero words.
+     */
+    [[nodiscard]] magnitudeStorage getMagnitude() const {
+        magnitudeStorage magnitude(this->bitset.begin(), this->bitset.end());
+        if (this->isNegative()) {
+            bool carry = true;
+            for (auto &word: magnitude) {
+                word = ~word + carry;
+                carry = carry && word == 0;
+            }
+            if (carry) {
+                magnitude.push_back(1);
+            }
+        }
+        trimMagnitude(magnitude);
+        return magnitude;
+    }
+
+    /**
+     * @return Count of limbs without leading limbs equal to sign extension (0 for -1 and 0).
+     */
+    [[nodiscard]] std::size_t getUsedLimbs() const {
+        const bitsetItem extension = this->isNegative() ? -1 : 0;
+        auto size = this->bitset.size();
+        while (size > 0 && this->bitset[size - 1] == extension) {
+            size--;
+        }
+        return size;
+    }
+
+    /**
+     * @return Value of this if it is non-negative and fits one word, 0 otherwise (used for progress estimates).
+     */
+    [[nodiscard]] std::size_t getSmallValue() const {
+        if (this->isNegative() || this->bitset.empty() ||
+            std::any_of(this->bitset.begin() + 1, this->bitset.end(), [](bitsetItem item) { return item != 0; })) {
+            return 0;
+        }
+        return static_cast<std::size_t>(this->bitset[0]);
+    }
+
+    /**
+     * @brief Divide magnitude in place by one word, dropping emptied leading words.
+     * @param words Magnitude words (least significant first).
+     * @param size Count of used words, updated after division.
+     * @param divisor Divisor with precomputed reciprocal.
+     * @return Remainder of division.
+     */
+    static std::uint64_t divideMagnitude(std::uint64_t *words, std::size_t &size, const MpKernels::Divisor &divisor) {
+        auto remainder = MpKernels::divRem1(words, words, size, divisor);
+        while (size > 0 && words[size - 1] == 0) {
+            size--;
+        }
+        return remainder;
+    }
+
+    /**
+     * @brief Build number from two's complement limbs. Throw MpIntException if number limitation is overflowed.
+     * @param words Limbs (least significant first), adopted by result.
+     * @param negative Sign of number (limbs above words are sign extension).
+     * @return Number with given limbs and sign, without leading sign extension limbs.
+     */
+    static MpInt fromTwosComplement(bitsetStorage &&words, bool negative) {
+        const bitsetItem extension = negative ? -1 : 0;
+        while (!words.empty() && words.back() == extension) {
+            words.pop_back();
+        }
+        if (bitPrecision != MP_INT_UNLIMITED && !words.empty()) {
+            // number fits if it (or -number - 1 for negative) has less than bitPrecision bits
+            auto bitLength = (words.size() - 1) * ELEMENT_BIT_SIZE +
+                             std::bit_width(static_cast<std::uint64_t>(words.back() ^ extension));
+            if (bitLength >= bitPrecision) {
+                throw MpIntException<MpInt<MP_INT_UNLIMITED>>(
+                        MpInt<MP_INT_UNLIMITED>::fromTwosComplement(std::move(words), negative));
+            }
+        }
+        MpInt result;
+        result.bitset = std::move(words);
+        result.negative = negative;
+        return result;
+    }
+
+    /**
+     * @brief Build number from magnitude words. Throw MpIntException if number limitation is overflowed.
+     * @param words Magnitude words (least significant first).
+     * @param negative Sign of number.
+     * @return Number with given magnitude and sign.
+     */
+    static MpInt fromMagnitude(magnitudeStorage &&words, bool negative) {
+        trimMagnitude(words);
+        if (words.empty()) {
+            return MpInt();
+        }
+        if (bitPrecision != MP_INT_UNLIMITED) {
+            auto bitLength = getBitLength(words);
+            auto onlyTopBit = std::has_single_bit(words.back()) &&
+                              std::all_of(words.begin(), words.end() - 1, [](auto word) { return word == 0; });
+            if (bitLength >= bitPrecision && !(negative && onlyTopBit && bitLength == bitPrecision)) {
+                throw MpIntException<MpInt<MP_INT_UNLIMITED>>(
+                        MpInt<MP_INT_UNLIMITED>::fromMagnitude(std::move(words), negative));
+            }
+        }
+        MpInt result;
+        result.bitset.assign(words.begin(), words.end());
+        if (negative) {
+            bool carry = true;
+            for (auto &item: result.bitset) {
+                auto word = ~static_cast<std::uint64_t>(item) + carry;
+                item = static_cast<bitsetItem>(word);
+                carry = carry && word == 0;
+            }
+            result.negative = true;
+        }
+        return result;
+    }
+
+    /**
+     * @brief Throw MpIntOverflowPredicted if result of given minimal bit length certainly overflows and is too large
+     * to be computed exactly for MpIntException.
+     * @param minimalBits Lower bound of bit length of magnitude of result.
+     */
+    static void checkPredictedOverflow(std::size_t minimalBits) {
+        if (bitPrecision != MP_INT_UNLIMITED && minimalBits > bitPrecision && minimalBits > OVERFLOW_VALUE_BITS) {
+            throw MpIntOverflowPredicted(minimalBits, bitPrecision);
+        }
+    }
+
+    /**
+     * @return Lower and upper bound of bit length of n! estimated from log-gamma (Stirling series).
+     */
+    static std::pair<std::size_t, std::size_t> predictFactorialBits(std::uint64_t n) {
+        auto bits = std::lgamma(static_cast<double>(n) + 1) / std::log(2.0);
+        // relative error of log-gamma is far below 1e-9
+        auto error = bits * 1e-9 + 2;
+        return {static_cast<std::size_t>(std::max(0.0, bits - error)) + 1, static_cast<std::size_t>(bits + error) + 1};
+    }
+
+    /**
+     * @return Bit length of magnitude.
+     */
+    static std::size_t getBitLength(const magnitudeStorage &magnitude) {
+        return magnitude.empty() ? 0 : (magnitude.size() - 1) * ELEMENT_BIT_SIZE + std::bit_width(magnitude.back());
+    }
+
+    /**
+     * @brief Drop leading zero words of magnitude.
+     */
+    static void trimMagnitude(magnitudeStorage &magnitude) {
+        while (!magnitude.empty() && magnitude.back() == 0) {
+            magnitude.pop_back();
+        }
+    }
+
+    /**
+     * @brief Compare magnitudes without leading zero words.
+     * @return Negative, zero or positive value as a is less, equal or greater than b.
+     */
+    static int compareMagnitudes(const magnitudeStorage &a, const magnitudeStorage &b) {
+        if (a.size() != b.size()) {
+            return a.size() < b.size() ? -1 : 1;
+        }
+        return MpKernels::compare(a.data(), b.data(), a.size());
+    }
+
+    /**
+     * @return Product of magnitudes without leading zero words.
+     */
+    static magnitudeStorage multiplyMagnitudes(const magnitudeStorage &a, const magnitudeStorage &b) {
+        magnitudeStorage product;
+        if (!a.empty() && !b.empty()) {
+            product.resize(a.size() + b.size());
+            MpKernels::multiply(product.data(), a.data(), a.size(), b.data(), b.size());
+            if (product.back() == 0) {
+                product.pop_back();
+            }
+        }
+        return product;
+    }
+
+    /**
+     * @return Quotient of magnitudes, b must not be empty.
+     */
+    static magnitudeStorage divideMagnitudes(const magnitudeStorage &a, const magnitudeStorage &b) {
+        if (compareMagnitudes(a, b) < 0) {
+            return {};
+        }
+        if (b.size() == 1) {
+            magnitudeStorage quotient(a.size());
+            MpKernels::divRem1(quotient.data(), a.data(), a.size(), b[0]);
+            return quotient;
+        }
+        magnitudeStorage quotient(a.size() - b.size() + 1);
+        MpKernels::divRem(quotient.data(), nullptr, a.data(), a.size(), b.data(), b.size());
+        return quotient;
+    }
+
+    /**
+     * @return Magnitude shifted left by bits.
+     */
+    static magnitudeStorage shiftLeftMagnitude(const magnitudeStorage &magnitude, std::size_t bits) {
+        if (magnitude.empty()) {
+            return {};
+        }
+        auto words = bits / ELEMENT_BIT_SIZE;
+        auto shift = bits % ELEMENT_BIT_SIZE;
+        magnitudeStorage shifted(magnitude.size() + words + 1, 0);
+        for (std::size_t i = 0; i < magnitude.size(); i++) {
+            shifted[i + words] |= magnitude[i] << shift;
+            shifted[i + words + 1] = shift == 0 ? 0 : magnitude[i] >> (ELEMENT_BIT_SIZE - shift);
+        }
+        if (shifted.back() == 0) {
+            shifted.pop_back();
+        }
+        return shifted;
+    }
+
+    /**
+     * @return Magnitude shifted right by bits without leading zero words.
+     */
+    static magnitudeStorage shiftRightMagnitude(const magnitudeStorage &magnitude, std::size_t bits) {
+        auto words = bits / ELEMENT_BIT_SIZE;
+        auto shift = bits % ELEMENT_BIT_SIZE;
+        if (words >= magnitude.size()) {
+            return {};
+        }
+        magnitudeStorage shifted(magnitude.size() - words);
+        for (std::size_t i = 0; i < shifted.size(); i++) {
+            auto next = i + words + 1 < magnitude.size() ? magnitude[i + words + 1] : 0;
+            shifted[i] = (magnitude[i + words] >> shift) | (shift == 0 ? 0 : next << (ELEMENT_BIT_SIZE - shift));
+        }
+        trimMagnitude(shifted);
+        return shifted;
+    }
+
+    /**
+     * @brief Floor of square root by Newton iteration from above. Start is root of upper half of bits (computed
+     * recursively), which is correct to a quarter of bits, so only few iterations run at full length.
+     * @return Square root of magnitude.
+     */
+    static magnitudeStorage sqrtMagnitude(const magnitudeStorage &magnitude) {
+        auto bits = getBitLength(magnitude);
+        if (bits == 0) {
+            return {};
+        }
+        magnitudeStorage root;
+        if (bits <= 2 * ELEMENT_BIT_SIZE) {
+            root = shiftLeftMagnitude(magnitudeStorage{1}, (bits + 1) / 2);
+        } else {
+            // (sqrt(n / 4^shift) + 1) * 2^shift is above square root of n
+            auto shift = bits / 4;
+            root = sqrtMagnitude(shiftRightMagnitude(magnitude, 2 * shift));
+            root.push_back(0);
+            MpKernels::add1(root.data(), root.data(), root.size(), 1);
+            if (root.back() == 0) {
+                root.pop_back();
+            }
+            root = shiftLeftMagnitude(root, shift);
+        }
+        while (true) {
+            // next = (root + n / root) / 2 decreases until it reaches floor of square root
+            auto next = divideMagnitudes(magnitude, root);
+            next.resize(std::max(next.size(), root.size()) + 1, 0);
+            auto carry = MpKernels::addN(next.data(), next.data(), root.data(), root.size());
+            MpKernels::add1(next.data() + root.size(), next.data() + root.size(), next.size() - root.size(), carry);
+            next = shiftRightMagnitude(next, 1);
+            if (compareMagnitudes(next, root) >= 0) {
+                return root;
+            }
+            root = std::move(next);
+        }
+    }
+
+    /**
+     * @brief Add or subtract numbers of any precisions directly on their two's complement limbs.
+     * @param subtract True if b is subtracted.
+     * @return a + b or a - b.
+     */
+    template<std::size_t otherBytePrecision>
+    static MpInt<maxPrecision<bytePrecision, otherBytePrecision>>
+    addSigned(const MpInt &a, const MpInt<otherBytePrecision> &b, bool subtract) {
+        auto size = std::max(a.bitset.size(), b.bitset.size());
+        bitsetStorage words(size + 1);
+        auto top = MpKernels::addSigned(reinterpret_cast<std::uint64_t *>(words.data()),
+                                        reinterpret_cast<const std::uint64_t *>(a.bitset.data()), a.bitset.size(),
+                                        a.isNegative(),
+                                        reinterpret_cast<const std::uint64_t *>(b.bitset.data()), b.bitset.size(),
+                                        b.isNegative(), subtract);
+        // limbs above result are top (-2 to 1), as one more limb with sign it is the limb itself
+        words[size] = top;
+        return MpInt<maxPrecision<bytePrecision, otherBytePrecision>>::fromTwosComplement(std::move(words), top < 0);
+    }
+
+    /**
+     * @return Product a * b of numbers of any precisions.
+     */
+    template<std::size_t otherBytePrecision>
+    static MpInt<maxPrecision<bytePrecision, otherBytePrecision>>
+    multiplySigned(const MpInt &a, const MpInt<otherBytePrecision> &b) {
+        auto aMagnitude = a.getMagnitude();
+        auto bMagnitude = b.getMagnitude();
+        if (!aMagnitude.empty() && !bMagnitude.empty()) {
+            MpInt<maxPrecision<bytePrecision, otherBytePrecision>>::checkPredictedOverflow(
+                    getBitLength(aMagnitude) + getBitLength(bMagnitude) - 1);
+        }
+        return MpInt<maxPrecision<bytePrecision, otherBytePrecision>>::fromMagnitude(
+                multiplyMagnitudes(aMagnitude, bMagnitude), a.isNegative() != b.isNegative());
+    }
+
+    /**
+     * @return Quotient a / b of numbers of any precisions rounded toward zero. Throw MpIntException if b is zero.
+     */
+    template<std::size_t otherBytePrecision>
+    static MpInt<maxPrecision<bytePrecision, otherBytePrecision>>
+    divideSigned(const MpInt &a, const MpInt<otherBytePrecision> &b) {
+        auto bMagnitude = b.getMagnitude();
+        if (bMagnitude.empty()) {
+            throw MpIntException<MpInt<MP_INT_UNLIMITED>>(MpInt<MP_INT_UNLIMITED>(0LL));
+        }
+        return MpInt<maxPrecision<bytePrecision, otherBytePrecision>>::fromMagnitude(
+                divideMagnitudes(a.getMagnitude(), bMagnitude), a.isNegative() != b.isNegative());
+    }
+
+    /**
+     * @brief Check that count of bits per digit is supported.
+     */
+    static void checkRadixBits(unsigned bitsPerDigit) {
+        if (bitsPerDigit == 0 || bitsPerDigit > MAX_RADIX_BITS) {
+            throw std::invalid_argument("Unsupported radix.");
+        }
+    }
+
+    /**
+     * @brief Parse unsigned digits of power-of-two radix.
+     * @param digits Digits without sign or prefix.
+     * @param bitsPerDigit Count of bits per digit (1 - binary, 4 - hexadecimal, ...).
+     * @param negative Sign of number.
+     * @return Parsed number.
+     */
+    static MpInt parseRadix(std::string_view digits, unsigned bitsPerDigit, bool negative) {
+        MpStats::Timer timer(MpStatsOperation::PARSE, digits.size());
+        if (digits.empty()) {
+            throw std::invalid_argument("Missing digits.");
+        }
+        magnitudeStorage words((digits.size() * bitsPerDigit + ELEMENT_BIT_SIZE - 1) / ELEMENT_BIT_SIZE, 0);
+        std::size_t position = 0;
+        for (auto i = digits.size(); i-- > 0; position += bitsPerDigit) {
+            std::uint64_t value = RADIX_DIGIT_VALUES[static_cast<unsigned char>(digits[i])];
+            if (value >> bitsPerDigit != 0) {
+                throw std::invalid_argument("Invalid digit.");
+            }
+            auto index = position / ELEMENT_BIT_SIZE;
+            auto offset = position % ELEMENT_BIT_SIZE;
+            words[index] |= value << offset;
+            if (offset + bitsPerDigit > ELEMENT_BIT_SIZE) {
+                words[index + 1] |= value >> (ELEMENT_BIT_SIZE - offset);
+            }
+        }
+        return fromMagnitude(std::move(words), negative);
+    }
+
+    /**
+     * @brief Inner class buffering output characters into fixed size blocks handed over to sink.
+     * @tparam Sink Callable accepting std::string_view.
+     */
+    template<class Sink>
+    class BlockWriter {
+    private:
+        /** Receiver of finished blocks */
+        Sink &sink;
+        /** Currently filled block */
+        std::array<char, OUTPUT_BLOCK_SIZE> block;
+        /** Used length of block */
+        std::size_t length = 0;
+        /** Count of digits not yet written */
+        std::size_t remainingDigits;
+        /** Count of digits in one group */
+        std::size_t groupSize;
+        /** Group separator, '\0' for no grouping */
+        char separator;
+
+    public:
+        /**
+         * @param sink Receiver of blocks.
+         * @param digits Count of digits which will be written.
+         * @param groupSize Count of digits in one group.
+         * @param separator Group separator, '\0' for no grouping.
+         */
+        BlockWriter(Sink &sink, std::size_t digits, std::size_t groupSize, char separator)
+                : sink(sink), remainingDigits(digits), groupSize(groupSize), separator(separator) {
+        }
+
+        /**
+         * @brief Write character which is not a digit (sign, prefix).
+         */
+        void put(char character) {
+            if (length == block.size()) {
+                flush();
+            }
+            block[length++] = character;
+        }
+
+        /**
+         * @brief Write digit followed by group separator if the group is complete.
+         */
+        void putDigit(char digit) {
+            put(digit);
+            if (separator != '\0' && --remainingDigits > 0 && remainingDigits % groupSize == 0) {
+                put(separator);
+            }
+        }
+
+        /**
+         * @brief Hand over buffered characters to sink.
+         */
+        void flush() {
+            if (length > 0) {
+                sink(std::string_view(block.data(), length));
+                length = 0;
+            }
+        }
+    };
+
     // ------------------------------------------------------
     // ------------------------------------------------------
     // ------------------ OPERATORS -------------------------
@@ -368,26 +943,8 @@ public:
     requires SizeLimitation<otherBytePrecision>
     friend MpInt<maxPrecision<bytePrecision, otherBytePrecision>>
     operator+(const MpInt<bytePrecision> &a, const MpInt<otherBytePrecision> &b) {
-        bool carry = false;
-        std::size_t index = 0;
-        auto maxCapacity = std::max(a.getCurrentCapacity(), b.getCurrentCapacity());
-        MpInt<maxPrecision<bytePrecision, otherBytePrecision>> result;
-        for (index = 0; index < maxCapacity; index++) {
-            bool b1 = a.getBit(index);
-            bool b2 = b.getBit(index);
-            result.setBit(index, b1 ^ b2 ^ carry);
-            carry = (b1 && b2) || (b1 && carry) || (b2 && carry);
-        }
-        result.negative = result.getBit(index - 1);
-        if ((!a.isNegative() && !b.isNegative() && result.isNegative()) ||
-            (a.isNegative() && b.isNegative() && !result.isNegative())) {
-            result.setNegative(!result.isNegative());
-            result.expand(index);
-            if (maxPrecision<bytePrecision, otherBytePrecision> != MP_INT_UNLIMITED) {
-                throw MpIntException<MpInt<MP_INT_UNLIMITED>>(MpInt<MP_INT_UNLIMITED>(result));
-            }
-        }
-        return result;
+        MpStats::Timer timer(MpStatsOperation::ADD, std::max(a.getCurrentCapacity(), b.getCurrentCapacity()));
+        return addSigned(a, b, false);
     }
 
     /**
@@ -401,30 +958,8 @@ public:
     requires SizeLimitation<otherBytePrecision>
     friend MpInt<maxPrecision<bytePrecision, otherBytePrecision>>
     operator-(const MpInt<bytePrecision> &a, const MpInt<otherBytePrecision> &b) {
-        bool borrow = false, diff;
-        int index;
-        auto maxCapacity = std::max(a.getCurrentCapacity(), b.getCurrentCapacity());
-        MpInt<maxPrecision<bytePrecision, otherBytePrecision>> result;
-        for (index = 0; index < maxCapacity; index++) {
-            bool b1 = a.getBit(index);
-            bool b2 = b.getBit(index);
-            if (borrow) {
-                diff = !(b1 ^ b2);
-                borrow = !b1 || b2;
-            } else {
-                diff = b1 ^ b2;
-                borrow = !b1 && b2;
-            }
-            result.setBit(index, diff);
-        }
-        result.negative = result.getBit(index - 1);
-        if ((a.isNegative() && !b.isNegative() && !result.negative) ||
-            (!a.isNegative() && b.isNegative() && result.negative)) {
-            result.negative = !result.isNegative();
-            result.expand(index);
-            throw MpIntException<MpInt<MP_INT_UNLIMITED>>(MpInt<MP_INT_UNLIMITED>(result));
-        }
-        return result;
+        MpStats::Timer timer(MpStatsOperation::SUBTRACT, std::max(a.getCurrentCapacity(), b.getCurrentCapacity()));
+        return addSigned(a, b, true);
     }
 
     /**
@@ -437,46 +972,14 @@ public:
     template<std::size_t otherBytePrecision>
     friend MpInt<maxPrecision<bytePrecision, otherBytePrecision>>
     operator*(const MpInt<bytePrecision> &a, const MpInt<otherBytePrecision> &b) {
-        const auto ZERO = MpInt<4>(0);
-        auto aNegative = a.isNegative();
-        auto bNegative = b.isNegative();
-        auto aCopy = a.abs();
-        auto bCopy = b.abs();
-        MpInt<MP_INT_UNLIMITED> tmpResult;
-        if (aCopy.getTopBit() >= bCopy.getTopBit()) {
-            for (int i = 0; i <= aCopy.getTopBit(); i++) {
-                if (aCopy.getBit(i)) {
-                    tmpResult += bCopy;
-                }
-                bCopy <<= 1;
-                if (bCopy.getBit(bCopy.getCurrentCapacity() - 1)) {
-                    bCopy.expand(bCopy.getCurrentCapacity());
-                }
-            }
-        } else {
-            for (int i = 0; i <= bCopy.getTopBit(); i++) {
-                if (bCopy.getBit(i)) {
-                    tmpResult += aCopy;
-                }
-                aCopy <<= 1;
-                if (aCopy.getBit(aCopy.getCurrentCapacity() - 1)) {
-                    aCopy.expand(aCopy.getCurrentCapacity());
-                }
-            }
-        }
-        if (aNegative ^ bNegative) {
-            tmpResult.setNegative(true);
-            tmpResult.secondComplement();
-        }
-        if (maxPrecision<bytePrecision, otherBytePrecision> != MP_INT_UNLIMITED &&
-            static_cast<long long>(maxPrecision<bytePrecision, otherBytePrecision>) * 8 < tmpResult.getTopBit()) {
-            throw MpIntException<MpInt<MP_INT_UNLIMITED>>(tmpResult);
-        }
-        return MpInt<maxPrecision<bytePrecision, otherBytePrecision>>(tmpResult);
+        MpStats::Timer timer(MpStatsOperation::MULTIPLY, std::max(a.getCurrentCapacity(), b.getCurrentCapacity()));
+        MpProgress::Scope progress("nasobeni");
+        return multiplySigned(a, b);
     }
 
     /**
-     * @brief Divide two numbers and return result. Throw MpIntException if number limitation is overflowed.
+     * @brief Divide two numbers and return result rounded toward zero. Throw MpIntException if number limitation
+     * is overflowed or divisor is zero.
      * @tparam otherBytePrecision Template of second parameter.
      * @param a First term.
      * @param b Second term.
@@ -486,26 +989,10 @@ public:
     requires SizeLimitation<otherBytePrecision>
     friend MpInt<maxPrecision<bytePrecision, otherBytePrecision>>
     operator/(const MpInt<bytePrecision> &divident, const MpInt<otherBytePrecision> &divisor) {
-        const MpInt<4> ONE = MpInt<4>(1LL);
-        const MpInt<4> ZERO = MpInt<4>(0LL);
-        MpInt<std::max(bytePrecision, otherBytePrecision)> quotient;
-        auto dividentNegative = divident.isNegative();
-        auto divisorNegative = divisor.isNegative();
-        auto dividentCopy = divident.abs();
-        auto divisorCopy = divisor.abs();
-
-        if (divisor == ZERO) {
-            throw MpIntException<MpInt<MP_INT_UNLIMITED>>(MpInt<MP_INT_UNLIMITED>(0LL));
-        }
-        while (dividentCopy >= divisorCopy) {
-            quotient = quotient + ONE;
-            dividentCopy = dividentCopy - divisorCopy;
-        }
-        if (dividentNegative ^ divisorNegative) {
-            quotient.setNegative(true);
-            quotient.secondComplement();
-        }
-        return quotient;
+        MpStats::Timer timer(MpStatsOperation::DIVIDE,
+                             std::max(divident.getCurrentCapacity(), divisor.getCurrentCapacity()));
+        MpProgress::Scope progress("deleni");
+        return divideSigned(divident, divisor);
     }
 
     /**
@@ -564,6 +1051,31 @@ public:
         return (thiz = thiz * multiplier);
     }
 
+    /**
+     * @brief Three-way comparison. Compares signs, then counts of used limbs and then limbs from the top, so that
+     * numbers of different magnitude are ordered in constant time.
+     * @tparam otherPrecision Template of second parameter.
+     * @param other Second parameter.
+     * @return Ordering of this and other.
+     */
+    template<std::size_t otherPrecision>
+    requires SizeLimitation<otherPrecision>
+    std::strong_ordering operator<=>(const MpInt<otherPrecision> &other) const {
+        if (this->isNegative() != other.isNegative()) {
+            return this->isNegative() ? std::strong_ordering::less : std::strong_ordering::greater;
+        }
+        auto size = this->getUsedLimbs();
+        auto otherSize = other.getUsedLimbs();
+        if (size != otherSize) {
+            // more limbs of negative number mean lower value
+            return (size < otherSize) != this->isNegative() ? std::strong_ordering::less
+                                                            : std::strong_ordering::greater;
+        }
+        // equal sign and count of limbs, so limbs compare as unsigned
+        return MpKernels::compare(reinterpret_cast<const std::uint64_t *>(this->bitset.data()),
+                                  reinterpret_cast<const std::uint64_t *>(other.bitset.data()), size) <=> 0;
+    }
+
     /**
      * @brief Equals operator.
      * @tparam otherPrecision Template of second parameter.
@@ -573,98 +1085,150 @@ public:
     template<std::size_t otherPrecision>
     requires SizeLimitation<otherPrecision>
     bool operator==(const MpInt<otherPrecision> &other) const {
-        if (this->isNegative() != other.isNegative()) {
-            return false;
+        return (*this <=> other) == 0;
+    }
+
+
+    // ------------------------------------------------------
+    // ------------------------------------------------------
+    // ------------------ INPUT -----------------------------
+    // ------------------------------------------------------
+    // ------------------------------------------------------
+public:
+    /**
+     * @brief Parse number written in power-of-two radix in linear time. Throw MpIntException if number limitation
+     * is overflowed and std::invalid_argument on invalid digit.
+     * @param text Digits with optional leading '-' or '+'.
+     * @param bitsPerDigit Count of bits per digit (1 - binary, 3 - octal, 4 - hexadecimal, 5 - base 32).
+     * @return Parsed number.
+     */
+    static MpInt fromRadix(std::string_view text, unsigned bitsPerDigit) {
+        checkRadixBits(bitsPerDigit);
+        bool negative = text.starts_with('-');
+        if (negative || text.starts_with('+')) {
+            text.remove_prefix(1);
+        }
+        return parseRadix(text, bitsPerDigit, negative);
+    }
+
+    /**
+     * @brief Parse decimal number of any length. Throw MpIntException if number limitation is overflowed and
+     * std::invalid_argument on invalid digit.
+     * @param text Decimal digits with optional leading '-' or '+'.
+     * @return Parsed number.
+     */
+    static MpInt fromDecimal(std::string_view text) {
+        MpStats::Timer timer(MpStatsOperation::PARSE, text.size());
+        bool negative = text.starts_with('-');
+        if (negative || text.starts_with('+')) {
+            text.remove_prefix(1);
         }
-        for (auto i = 0; i < std::max(this->bitPrecision, other.bitPrecision); i++) {
-            if (this->getBit(i) != other.getBit(i)) {
-                return false;
+        if (text.empty()) {
+            throw std::invalid_argument("Missing digits.");
+        }
+        magnitudeStorage words;
+        words.reserve(text.size() / DECIMAL_CHUNK_DIGITS + 1);
+        auto length = text.size() % DECIMAL_CHUNK_DIGITS;
+        for (std::size_t position = 0; position < text.size(); position += length, length = DECIMAL_CHUNK_DIGITS) {
+            if (length == 0) {
+                length = DECIMAL_CHUNK_DIGITS;
+            }
+            std::uint64_t chunk = 0, multiplier = 1;
+            for (char digit: text.substr(position, length)) {
+                if (digit < '0' || digit > '9') {
+                    throw std::invalid_argument("Invalid digit.");
+                }
+                chunk = chunk * 10 + (digit - '0');
+                multiplier *= 10;
+            }
+            auto carry = MpKernels::mul1(words.data(), words.data(), words.size(), multiplier);
+            carry += MpKernels::add1(words.data(), words.data(), words.size(), chunk);
+            if (carry != 0) {
+                words.push_back(carry);
             }
         }
-        return true;
+        return fromMagnitude(std::move(words), negative);
     }
 
     /**
-     * @tparam otherBytePrecision Template of second parameter.
-     * @param a First term.
-     * @param b Second term.
-     * @return True if a >= b. False otherwise.
+     * @brief Parse hexadecimal number in linear time. Throw MpIntException if number limitation is overflowed and
+     * std::invalid_argument on invalid digit.
+     * @param text Hexadecimal digits with optional leading '-' or '+' and optional "0x" prefix.
+     * @return Parsed number.
      */
-    template<std::size_t otherBytePrecision>
-    requires SizeLimitation<otherBytePrecision>
-    friend bool operator>=(const MpInt<bytePrecision> &a, const MpInt<otherBytePrecision> &b) {
-        const size_t size = std::max(a.getCurrentCapacity(), b.getCurrentCapacity());
-        if (a.isNegative() && !b.isNegative()) return false;
-        if (!a.isNegative() && b.isNegative()) return true;
-        bool bothNegative = a.isNegative();
-        for (int index = size - 1; index >= 0; index--) {
-            if (a.getBit(index) && !b.getBit(index)) return !bothNegative;
-            if (!a.getBit(index) && b.getBit(index)) return bothNegative;
+    static MpInt fromHex(std::string_view text) {
+        bool negative = text.starts_with('-');
+        if (negative || text.starts_with('+')) {
+            text.remove_prefix(1);
         }
-        return true;
+        if (text.starts_with("0x") || text.starts_with("0X")) {
+            text.remove_prefix(2);
+        }
+        return parseRadix(text, 4, negative);
     }
 
+    // ------------------------------------------------------
+    // ------------------------------------------------------
+    // ------------------ RANDOM ----------------------------
+    // ------------------------------------------------------
+    // ------------------------------------------------------
+public:
     /**
-     * @tparam otherBytePrecision Template of second parameter.
-     * @param a First term.
-     * @param b Second term.
-     * @return True if a > b. False otherwise.
+     * @brief Uniformly random non-negative number below 2^bits, limbs are filled directly from engine. Throw
+     * MpIntException if number limitation is overflowed.
+     * @param bits Count of random bits.
+     * @param engine Random generator (MpRandom is the fastest).
+     * @return Random number.
      */
-    template<std::size_t otherBytePrecision>
-    requires SizeLimitation<otherBytePrecision>
-    friend bool operator>(const MpInt<bytePrecision> &a, const MpInt<otherBytePrecision> &b) {
-        const size_t size = std::max(a.getCurrentCapacity(), b.getCurrentCapacity());
-        if (a.isNegative() && !b.isNegative()) return false;
-        if (!a.isNegative() && b.isNegative()) return true;
-        bool bothNegative = a.isNegative();
-        for (int index = size - 1; index >= 0; index--) {
-            if (a.getBit(index) && !b.getBit(index)) return !bothNegative;
-            if (!a.getBit(index) && b.getBit(index)) return bothNegative;
-        }
-        return false;
+    template<std::uniform_random_bit_generator Engine>
+    static MpInt random(std::size_t bits, Engine &engine) {
+        bitsetStorage words((bits + ELEMENT_BIT_SIZE - 1) / ELEMENT_BIT_SIZE);
+        fillRandom(reinterpret_cast<std::uint64_t *>(words.data()), words.size(), bits, engine);
+        return fromTwosComplement(std::move(words), false);
     }
 
     /**
-     * @tparam otherBytePrecision Template of second parameter.
-     * @param a First term.
-     * @param b Second term.
-     * @return True if a <= b. False otherwise.
+     * @brief Uniformly random number in range [0, bound) by rejection sampling of numbers with bit length of bound
+     * (less than two draws on average). Throw std::invalid_argument if bound is not positive.
+     * @param bound Exclusive upper bound.
+     * @param engine Random generator (MpRandom is the fastest).
+     * @return Random number.
      */
-    template<std::size_t otherBytePrecision>
-    requires SizeLimitation<otherBytePrecision>
-    friend bool operator<=(const MpInt<bytePrecision> &a, const MpInt<otherBytePrecision> &b) {
-        const size_t size = std::max(a.getCurrentCapacity(), b.getCurrentCapacity());
-        if (a.isNegative() && !b.isNegative()) return true;
-        if (!a.isNegative() && b.isNegative()) return false;
-        bool bothNegative = a.isNegative();
-        for (int index = size - 1; index >= 0; index--) {
-            if (a.getBit(index) && !b.getBit(index)) return bothNegative;
-            if (!a.getBit(index) && b.getBit(index)) return !bothNegative;
+    template<std::uniform_random_bit_generator Engine>
+    static MpInt randomBelow(const MpInt &bound, Engine &engine) {
+        auto magnitude = bound.getMagnitude();
+        if (bound.isNegative() || magnitude.empty()) {
+            throw std::invalid_argument("Bound must be positive.");
         }
-        return true;
+        auto bits = getBitLength(magnitude);
+        magnitudeStorage words(magnitude.size());
+        do {
+            fillRandom(words.data(), words.size(), bits, engine);
+        } while (MpKernels::compare(words.data(), magnitude.data(), words.size()) >= 0);
+        return fromMagnitude(std::move(words), false);
     }
 
+private:
     /**
-     * @tparam otherBytePrecision Template of second parameter.
-     * @param a First term.
-     * @param b Second term.
-     * @return True if a < b. False otherwise.
+     * @brief Fill words with random bits, bits above given count are cleared.
      */
-    template<std::size_t otherBytePrecision>
-    requires SizeLimitation<otherBytePrecision>
-    friend bool operator<(const MpInt<bytePrecision> &a, const MpInt<otherBytePrecision> &b) {
-        const size_t size = std::max(a.getCurrentCapacity(), b.getCurrentCapacity());
-        if (a.isNegative() && !b.isNegative()) return true;
-        if (!a.isNegative() && b.isNegative()) return false;
-        bool bothNegative = a.isNegative();
-        for (int index = size - 1; index >= 0; index--) {
-            if (a.getBit(index) && !b.getBit(index)) return bothNegative;
-            if (!a.getBit(index) && b.getBit(index)) return !bothNegative;
+    template<std::uniform_random_bit_generator Engine>
+    static void fillRandom(std::uint64_t *words, std::size_t size, std::size_t bits, Engine &engine) {
+        if constexpr (Engine::min() == 0 && Engine::max() == UINT64_MAX) {
+            for (std::size_t i = 0; i < size; i++) {
+                words[i] = engine();
+            }
+        } else {
+            std::uniform_int_distribution<std::uint64_t> distribution;
+            for (std::size_t i = 0; i < size; i++) {
+                words[i] = distribution(engine);
+            }
+        }
+        if (bits % ELEMENT_BIT_SIZE != 0) {
+            words[size - 1] &= (std::uint64_t(1) << (bits % ELEMENT_BIT_SIZE)) - 1;
         }
-        return false;
     }
 
-
     // ------------------------------------------------------
     // ------------------------------------------------------
     // ------------------ OUTPUT ----------------------------
@@ -676,67 +1240,227 @@ public:
      * @return String of binary represented numbers.
      */
     [[nodiscard]] std::string toBinary() const {
-        std::string res;
         if (getCurrentCapacity() == 0) {
             return "0";
         }
-        for (auto i = 0; i < getCurrentCapacity(); i++) {
-            res += this->getBit(i) ? '1' : '0';
+        std::string res;
+        res.reserve(getCurrentCapacity());
+        for (auto i = this->bitset.size(); i-- > 0;) {
+            auto word = static_cast<std::uint64_t>(this->bitset[i]);
+            for (auto bit = ELEMENT_BIT_SIZE; bit-- > 0;) {
+                res += (word >> bit) & 1 ? '1' : '0';
+            }
         }
-        std::reverse(res.begin(), res.end());
         return res;
     }
 
+    /**
+     * @return Hexadecimal string of absolute value with leading '-' if negative.
+     */
+    [[nodiscard]] std::string toHex() const {
+        return toRadix(4);
+    }
+
+    /**
+     * @param bitsPerDigit Count of bits per digit (1 - binary, 3 - octal, 4 - hexadecimal, 5 - base 32).
+     * @return String of absolute value in power-of-two radix with leading '-' if negative.
+     */
+    [[nodiscard]] std::string toRadix(unsigned bitsPerDigit) const {
+        std::string result;
+        this->writeRadix([&result](std::string_view chunk) { result += chunk; }, bitsPerDigit);
+        return result;
+    }
+
     /**
      * @brief Make decimal string from binary representation of number.
      * @return Decimal string.
      */
     [[nodiscard]] std::string toDecimal() const {
-        auto copy = this->abs();
-        auto binary = copy.toBinary();
-        std::vector<int> intNumbers, tmpIntNumbers;
-        int bitLength, tmpIntLength, intLength;
-        std::size_t index;
-
-        intNumbers.resize(binary.length());
-        tmpIntNumbers.resize(binary.length());
-        tmpIntNumbers[0] = 1;
-        tmpIntLength = 1;
-        intLength = 1;
-        bitLength = binary.length();
-        for (int i = bitLength - 1; i >= 0; i--) {
-            if (binary[i] == '1') {
-                for (index = 0; index < tmpIntLength; index++) {
-                    intNumbers[index] +=
-                            tmpIntNumbers[index];
-                    if (intNumbers[index] > 9) {
-                        intNumbers[index + 1]++;
-                        intNumbers[index] -= 10;
-                    }
-                }
-                intLength = index;
-                if (intNumbers[index] != 0) {
-                    intLength++;
-                }
+        std::string result;
+        this->writeDecimal([&result](std::string_view chunk) { result += chunk; });
+        return result;
+    }
+
+    /**
+     * @brief Write decimal representation of number to sink in blocks of OUTPUT_BLOCK_SIZE characters.
+     * The magnitude is divided word-wise by 10^19 and the resulting chunks are stored in the words freed by
+     * division, so memory beyond one copy of the magnitude is a single output block.
+     * @tparam Sink Callable accepting std::string_view.
+     * @param sink Receiver of decimal text.
+     * @param separator Thousands separator, '\0' for no grouping.
+     */
+    template<class Sink>
+    void writeDecimal(Sink &&sink, char separator = '\0') const {
+        MpStats::Timer timer(MpStatsOperation::FORMAT, 1);
+        auto words = this->getMagnitude();
+        std::size_t size = words.size();
+        words.resize(size + size / 63 + 2);
+        std::size_t first = words.size();
+        MpProgress::Scope progress("prevod do desitkove soustavy");
+        const auto totalWords = size;
+        while (size > 0) {
+            MpProgress::checkpoint();
+            progress.report(totalWords - size, totalWords);
+            words[--first] = divideMagnitude(words.data(), size, DECIMAL_CHUNK_DIVISOR);
+        }
+        if (first == words.size()) {
+            sink(std::string_view("0"));
+            return;
+        }
+        auto leading = std::to_string(words[first]);
+        BlockWriter<Sink> writer(sink, leading.size() + (words.size() - first - 1) * DECIMAL_CHUNK_DIGITS, 3,
+                                 separator);
+        timer.setSize(leading.size() + (words.size() - first - 1) * DECIMAL_CHUNK_DIGITS);
+        if (this->negative) {
+            writer.put('-');
+        }
+        for (char digit: leading) {
+            writer.putDigit(digit);
+        }
+        char digits[DECIMAL_CHUNK_DIGITS];
+        for (auto i = first + 1; i < words.size(); i++) {
+            auto chunk = words[i];
+            for (auto d = DECIMAL_CHUNK_DIGITS; d-- > 0;) {
+                digits[d] = static_cast<char>('0' + chunk % 10);
+                chunk /= 10;
             }
-            for (index = 0; index < tmpIntLength; index++) {
-                tmpIntNumbers[index] += tmpIntNumbers[index];
+            for (char digit: digits) {
+                writer.putDigit(digit);
             }
-            for (index = 0; index < tmpIntLength; index++) {
-                if (tmpIntNumbers[index] > 9) {
-                    tmpIntNumbers[index] -= 10;
-                    tmpIntNumbers[index + 1]++;
-                }
+        }
+        writer.flush();
+    }
+
+    /**
+     * @brief Write absolute value (with leading '-' if negative) in power-of-two radix to sink in linear time.
+     * @tparam Sink Callable accepting std::string_view.
+     * @param sink Receiver of text.
+     * @param bitsPerDigit Count of bits per digit (1 - binary, 3 - octal, 4 - hexadecimal, 5 - base 32).
+     * @param upper Use upper case digits.
+     * @param separator Separator of digit groups (three octal, four other digits), '\0' for no grouping.
+     */
+    template<class Sink>
+    void writeRadix(Sink &&sink, unsigned bitsPerDigit, bool upper = false, char separator = '\0') const {
+        checkRadixBits(bitsPerDigit);
+        MpStats::Timer timer(MpStatsOperation::FORMAT, 1);
+        const char *alphabet = upper ? RADIX_DIGITS_UPPER : RADIX_DIGITS_LOWER;
+        const std::uint64_t mask = (std::uint64_t(1) << bitsPerDigit) - 1;
+        auto words = this->getMagnitude();
+        if (words.empty()) {
+            sink(std::string_view("0"));
+            return;
+        }
+        auto bitLength = (words.size() - 1) * ELEMENT_BIT_SIZE + std::bit_width(words.back());
+        auto digits = (bitLength + bitsPerDigit - 1) / bitsPerDigit;
+        BlockWriter<Sink> writer(sink, digits, bitsPerDigit == 3 ? 3 : 4, separator);
+        timer.setSize(digits);
+        if (this->negative) {
+            writer.put('-');
+        }
+        for (auto position = (digits - 1) * bitsPerDigit;; position -= bitsPerDigit) {
+            auto index = position / ELEMENT_BIT_SIZE;
+            auto offset = position % ELEMENT_BIT_SIZE;
+            auto value = words[index] >> offset;
+            if (offset + bitsPerDigit > ELEMENT_BIT_SIZE && index + 1 < words.size()) {
+                value |= words[index + 1] << (ELEMENT_BIT_SIZE - offset);
             }
-            if (tmpIntNumbers[index] != 0) {
-                tmpIntLength++;
+            writer.putDigit(alphabet[value & mask]);
+            if (position == 0) {
+                break;
             }
         }
-        std::string result;
-        for (int i = intLength - 1; i >= 0; i--) {
-            result += std::to_string(intNumbers[i]);
+        writer.flush();
+    }
+
+    /**
+     * @brief Write hexadecimal representation of absolute value (with leading '-' if negative) to sink.
+     * @tparam Sink Callable accepting std::string_view.
+     * @param sink Receiver of hexadecimal text.
+     * @param upper Use upper case digits.
+     * @param separator Separator of groups of four digits, '\0' for no grouping.
+     */
+    template<class Sink>
+    void writeHex(Sink &&sink, bool upper = false, char separator = '\0') const {
+        this->writeRadix(std::forward<Sink>(sink), 4, upper, separator);
+    }
+
+    /**
+     * @brief Stream number in decimal (or hexadecimal/octal if std::hex/std::oct is set) without building whole
+     * string.
+     */
+    friend std::ostream &operator<<(std::ostream &stream, const MpInt &value) {
+        auto sink = [&stream](std::string_view chunk) { stream.write(chunk.data(), chunk.size()); };
+        if ((stream.flags() & std::ios::basefield) == std::ios::hex) {
+            value.writeHex(sink, stream.flags() & std::ios::uppercase);
+        } else if ((stream.flags() & std::ios::basefield) == std::ios::oct) {
+            value.writeRadix(sink, 3);
+        } else {
+            value.writeDecimal(sink);
+        }
+        return stream;
+    }
+};
+
+/** Common precisions are compiled once in MpInt.cpp (library mpint) */
+extern template class MpInt<MP_INT_UNLIMITED>;
+extern template class MpInt<4>;
+extern template class MpInt<8>;
+extern template class MpInt<16>;
+extern template class MpInt<32>;
+
+#ifdef __cpp_lib_format
+
+/**
+ * @brief Formatter of MpInt for std::format. Specification is [#][,|_|'][d|x|X|o|b] where '#' adds "0x", "0o"
+ * or "0b" prefix and the separator groups three decimal or octal digits and four other digits.
+ */
+template<std::size_t bytePrecision> requires SizeLimitation<bytePrecision>
+struct std::formatter<MpInt<bytePrecision>, char> {
+    /** Output type - 'd', 'x', 'X', 'o' or 'b' */
+    char type = 'd';
+    /** Group separator, '\0' for no grouping */
+    char separator = '\0';
+    /** Prefix hexadecimal output with "0x" */
+    bool alternate = false;
+
+    constexpr auto parse(std::format_parse_context &context) {
+        auto it = context.begin();
+        if (it != context.end() && *it == '#') {
+            alternate = true;
+            it++;
+        }
+        if (it != context.end() && (*it == ',' || *it == '_' || *it == '\'')) {
+            separator = *it++;
+        }
+        if (it != context.end() && (*it == 'd' || *it == 'x' || *it == 'X' || *it == 'o' || *it == 'b')) {
+            type = *it++;
+        }
+        if (it != context.end() && *it != '}') {
+            throw std::format_error("Invalid format specification for MpInt.");
+        }
+        return it;
+    }
+
+    template<class FormatContext>
+    auto format(const MpInt<bytePrecision> &value, FormatContext &context) const {
+        auto out = context.out();
+        auto sink = [&out](std::string_view chunk) { out = std::copy(chunk.begin(), chunk.end(), out); };
+        if (type == 'd') {
+            value.writeDecimal(sink, separator);
+            return out;
+        }
+        unsigned bitsPerDigit = type == 'o' ? 3 : type == 'b' ? 1 : 4;
+        if (alternate) {
+            if (value.isNegative()) {
+                *out++ = '-';
+            }
+            sink(type == 'o' ? std::string_view("0o") : type == 'b' ? std::string_view("0b") : std::string_view("0x"));
+            value.abs().writeRadix(sink, bitsPerDigit, type == 'X', separator);
+        } else {
+            value.writeRadix(sink, bitsPerDigit, type == 'X', separator);
         }
-        return this->negative ? '-' + result : result;
+        return out;
     }
 };
 
+#endif
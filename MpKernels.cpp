@@ -0,0 +1,307 @@
+#include "MpKernels.h"
+#include "MpProgress.h"
+#include "MpStorage.h"
+#include <algorithm>
+#include <bit>
+#include <cstdlib>
+#include <string_view>
+#include <vector>
+
+/** Double limb used for products and carries */
+typedef unsigned __int128 doubleLimb;
+
+constinit MpKernels::Table MpKernels::table = {addNPortable, subNPortable, mul1Portable, addMul1Portable,
+                                               subMul1Portable, comparePortable, "portable"};
+
+const bool MpKernels::selected = MpKernels::select();
+
+bool MpKernels::select() {
+    auto setting = std::getenv("MPINT_KERNELS");
+    if (setting != nullptr && std::string_view(setting) == "portable") {
+        return true;
+    }
+#ifdef MP_INT_X86_KERNELS
+    __builtin_cpu_init();
+    bool adx = __builtin_cpu_supports("adx") && __builtin_cpu_supports("bmi2");
+    bool avx512 = __builtin_cpu_supports("avx512f");
+    bool avx2 = __builtin_cpu_supports("avx2");
+    if (adx) {
+        table.addN = addNAdx;
+        table.subN = subNAdx;
+        table.mul1 = mul1Bmi2;
+        table.addMul1 = addMul1Adx;
+        table.subMul1 = subMul1Adx;
+    }
+    if (avx512) {
+        table.compare = compareAvx512;
+    } else if (avx2) {
+        table.compare = compareAvx2;
+    }
+    table.variant = adx ? (avx512 ? "adx+bmi2, avx512" : avx2 ? "adx+bmi2, avx2" : "adx+bmi2")
+                        : (avx512 ? "avx512" : avx2 ? "avx2" : "portable");
+#endif
+    return true;
+}
+
+std::uint64_t MpKernels::addNPortable(std::uint64_t *result, const std::uint64_t *a, const std::uint64_t *b,
+                                      std::size_t size) {
+    std::uint64_t carry = 0;
+    for (std::size_t i = 0; i < size; i++) {
+        auto sum = a[i] + carry;
+        carry = sum < carry;
+        result[i] = sum + b[i];
+        carry += result[i] < sum;
+    }
+    return carry;
+}
+
+std::uint64_t MpKernels::add1(std::uint64_t *result, const std::uint64_t *a, std::size_t size,
+                              std::uint64_t carry) {
+    for (std::size_t i = 0; i < size; i++) {
+        result[i] = a[i] + carry;
+        carry = result[i] < carry;
+    }
+    return carry;
+}
+
+std::uint64_t MpKernels::subNPortable(std::uint64_t *result, const std::uint64_t *a, const std::uint64_t *b,
+                                      std::size_t size) {
+    std::uint64_t borrow = 0;
+    for (std::size_t i = 0; i < size; i++) {
+        auto subtrahend = b[i] + borrow;
+        borrow = subtrahend < borrow;
+        borrow += a[i] < subtrahend;
+        result[i] = a[i] - subtrahend;
+    }
+    return borrow;
+}
+
+std::uint64_t MpKernels::sub1(std::uint64_t *result, const std::uint64_t *a, std::size_t size,
+                              std::uint64_t borrow) {
+    for (std::size_t i = 0; i < size; i++) {
+        auto next = a[i] < borrow;
+        result[i] = a[i] - borrow;
+        borrow = next;
+    }
+    return borrow;
+}
+
+int MpKernels::addSigned(std::uint64_t *result, const std::uint64_t *a, std::size_t aSize, bool aNegative,
+                         const std::uint64_t *b, std::size_t bSize, bool bNegative, bool subtract) {
+    auto common = std::min(aSize, bSize);
+    std::uint64_t carry = subtract ? subN(result, a, b, common) : addN(result, a, b, common);
+    // rest of longer operand against sign extension (all zero or all one limbs) of shorter one, adding all one
+    // limbs of length k is subtracting 1 and adding 2^(64 * k), the latter goes to carry
+    if (aSize > common) {
+        auto size = aSize - common;
+        auto extended = bNegative;
+        if (subtract) {
+            carry = extended ? 1 - add1(result + common, a + common, size, 1 - carry)
+                             : sub1(result + common, a + common, size, carry);
+        } else {
+            carry = extended ? 1 - sub1(result + common, a + common, size, 1 - carry)
+                             : add1(result + common, a + common, size, carry);
+        }
+    } else if (bSize > common) {
+        auto size = bSize - common;
+        auto extended = aNegative;
+        if (subtract) {
+            // extension - b = ~b + (1 if extension is zero) - 2^(64 * k) if extension is zero
+            for (std::size_t i = common; i < bSize; i++) {
+                result[i] = ~b[i];
+            }
+            carry = extended ? sub1(result + common, result + common, size, carry)
+                             : 1 - add1(result + common, result + common, size, 1 - carry);
+        } else {
+            carry = extended ? 1 - sub1(result + common, b + common, size, 1 - carry)
+                             : add1(result + common, b + common, size, carry);
+        }
+    }
+    // carry is borrow for subtraction
+    return subtract ? static_cast<int>(bNegative) - static_cast<int>(aNegative) - static_cast<int>(carry)
+                    : static_cast<int>(carry) - static_cast<int>(aNegative) - static_cast<int>(bNegative);
+}
+
+std::uint64_t MpKernels::mul1Portable(std::uint64_t *result, const std::uint64_t *a, std::size_t size,
+                                      std::uint64_t multiplier) {
+    std::uint64_t carry = 0;
+    for (std::size_t i = 0; i < size; i++) {
+        doubleLimb product = static_cast<doubleLimb>(a[i]) * multiplier + carry;
+        result[i] = static_cast<std::uint64_t>(product);
+        carry = static_cast<std::uint64_t>(product >> 64);
+    }
+    return carry;
+}
+
+std::uint64_t MpKernels::addMul1Portable(std::uint64_t *result, const std::uint64_t *a, std::size_t size,
+                                         std::uint64_t multiplier) {
+    std::uint64_t carry = 0;
+    for (std::size_t i = 0; i < size; i++) {
+        doubleLimb product = static_cast<doubleLimb>(a[i]) * multiplier + result[i] + carry;
+        result[i] = static_cast<std::uint64_t>(product);
+        carry = static_cast<std::uint64_t>(product >> 64);
+    }
+    return carry;
+}
+
+std::uint64_t MpKernels::subMul1Portable(std::uint64_t *result, const std::uint64_t *a, std::size_t size,
+                                         std::uint64_t multiplier) {
+    std::uint64_t borrow = 0;
+    for (std::size_t i = 0; i < size; i++) {
+        doubleLimb product = static_cast<doubleLimb>(a[i]) * multiplier + borrow;
+        auto low = static_cast<std::uint64_t>(product);
+        borrow = static_cast<std::uint64_t>(product >> 64) + (result[i] < low);
+        result[i] -= low;
+    }
+    return borrow;
+}
+
+std::uint64_t MpKernels::divRem1(std::uint64_t *quotient, const std::uint64_t *a, std::size_t size,
+                                 std::uint64_t divisor) {
+    doubleLimb remainder = 0;
+    for (auto i = size; i-- > 0;) {
+        remainder = (remainder << 64) | a[i];
+        quotient[i] = static_cast<std::uint64_t>(remainder / divisor);
+        remainder %= divisor;
+    }
+    return static_cast<std::uint64_t>(remainder);
+}
+
+std::uint64_t MpKernels::divRem1(std::uint64_t *quotient, const std::uint64_t *a, std::size_t size,
+                                 const Divisor &divisor) {
+    // dividend is shifted by the same bits as divisor on the fly, remainder stays below normalized divisor
+    const auto d = divisor.normalized;
+    const auto shift = divisor.shift;
+    std::uint64_t remainder = size == 0 || shift == 0 ? 0 : a[size - 1] >> (64 - shift);
+    for (auto i = size; i-- > 0;) {
+        auto low = (a[i] << shift) | (i == 0 || shift == 0 ? 0 : a[i - 1] >> (64 - shift));
+        // estimate from reciprocal is off by at most one in either direction (udiv_qrnnd_preinv)
+        auto estimate = static_cast<doubleLimb>(divisor.reciprocal) * remainder +
+                        ((static_cast<doubleLimb>(remainder + 1) << 64) | low);
+        auto digit = static_cast<std::uint64_t>(estimate >> 64);
+        auto rest = low - digit * d;
+        if (rest > static_cast<std::uint64_t>(estimate)) {
+            digit--;
+            rest += d;
+        }
+        if (rest >= d) {
+            digit++;
+            rest -= d;
+        }
+        quotient[i] = digit;
+        remainder = rest;
+    }
+    return remainder >> shift;
+}
+
+std::uint64_t MpKernels::mod1(const std::uint64_t *a, std::size_t size, std::uint64_t divisor) {
+    doubleLimb remainder = 0;
+    for (auto i = size; i-- > 0;) {
+        remainder = ((remainder << 64) | a[i]) % divisor;
+    }
+    return static_cast<std::uint64_t>(remainder);
+}
+
+std::uint64_t MpKernels::mod1(const std::uint64_t *a, std::size_t size, const Divisor &divisor) {
+    std::uint64_t remainder = 0;
+    for (auto i = size; i-- > 0;) {
+        remainder = divisor.remainder(remainder, a[i]);
+    }
+    return remainder;
+}
+
+int MpKernels::comparePortable(const std::uint64_t *a, const std::uint64_t *b, std::size_t size) {
+    for (auto i = size; i-- > 0;) {
+        if (a[i] != b[i]) {
+            return a[i] < b[i] ? -1 : 1;
+        }
+    }
+    return 0;
+}
+
+void MpKernels::multiply(std::uint64_t *result, const std::uint64_t *a, std::size_t aSize, const std::uint64_t *b,
+                         std::size_t bSize) {
+    // longer operand in inner loop
+    if (aSize < bSize) {
+        std::swap(a, b);
+        std::swap(aSize, bSize);
+    }
+    result[aSize] = mul1(result, a, aSize, b[0]);
+    for (std::size_t i = 1; i < bSize; i++) {
+        MpProgress::checkpoint();
+        result[aSize + i] = addMul1(result + i, a, aSize, b[i]);
+    }
+}
+
+void MpKernels::divRem(std::uint64_t *quotient, std::uint64_t *remainder, const std::uint64_t *a,
+                       std::size_t aSize, const std::uint64_t *b, std::size_t bSize) {
+    // normalize, so that top bit of divisor is set and quotient estimates are off by at most two
+    const auto shift = std::countl_zero(b[bSize - 1]);
+    std::vector<std::uint64_t, MpAllocator<std::uint64_t>> v(bSize), u(aSize + 1);
+    for (auto i = bSize; i-- > 1;) {
+        v[i] = (b[i] << shift) | (shift == 0 ? 0 : b[i - 1] >> (64 - shift));
+    }
+    v[0] = b[0] << shift;
+    u[aSize] = shift == 0 ? 0 : a[aSize - 1] >> (64 - shift);
+    for (auto i = aSize; i-- > 1;) {
+        u[i] = (a[i] << shift) | (shift == 0 ? 0 : a[i - 1] >> (64 - shift));
+    }
+    u[0] = a[0] << shift;
+
+    const auto top = v[bSize - 1];
+    const auto second = v[bSize - 2];
+    for (auto j = aSize - bSize + 1; j-- > 0;) {
+        MpProgress::checkpoint();
+        doubleLimb numerator = (static_cast<doubleLimb>(u[j + bSize]) << 64) | u[j + bSize - 1];
+        doubleLimb estimate = numerator / top;
+        doubleLimb estimateRemainder = numerator % top;
+        while ((estimate >> 64) != 0 ||
+               estimate * second > ((estimateRemainder << 64) | u[j + bSize - 2])) {
+            estimate--;
+            estimateRemainder += top;
+            if ((estimateRemainder >> 64) != 0) {
+                break;
+            }
+        }
+        auto digit = static_cast<std::uint64_t>(estimate);
+        auto borrow = subMul1(u.data() + j, v.data(), bSize, digit);
+        auto overflow = u[j + bSize] < borrow;
+        u[j + bSize] -= borrow;
+        if (overflow) {
+            digit--;
+            u[j + bSize] += addN(u.data() + j, u.data() + j, v.data(), bSize);
+        }
+        quotient[j] = digit;
+    }
+    if (remainder != nullptr) {
+        for (std::size_t i = 0; i < bSize; i++) {
+            remainder[i] = (u[i] >> shift) | (shift == 0 ? 0 : u[i + 1] << (64 - shift));
+        }
+    }
+}
+
+void MpKernels::montgomeryMultiply(std::uint64_t *result, const std::uint64_t *a, const std::uint64_t *b,
+                                   const std::uint64_t *m, std::size_t size, std::uint64_t inverse,
+                                   std::uint64_t *scratch) {
+    // scratch accumulates a * b + q * m, every step clears one low limb, so that the result is in the upper half
+    std::fill(scratch, scratch + 2 * size + 1, 0);
+    for (std::size_t i = 0; i < size; i++) {
+        auto carry = addMul1(scratch + i, a, size, b[i]);
+        for (auto j = i + size; carry != 0; j++) {
+            scratch[j] += carry;
+            carry = scratch[j] < carry;
+        }
+        auto q = scratch[i] * inverse;
+        carry = addMul1(scratch + i, m, size, q);
+        for (auto j = i + size; carry != 0; j++) {
+            scratch[j] += carry;
+            carry = scratch[j] < carry;
+        }
+    }
+    // upper half is less than 2 * m
+    if (scratch[2 * size] != 0 || compare(scratch + size, m, size) >= 0) {
+        subN(result, scratch + size, m, size);
+    } else {
+        std::copy(scratch + size, scratch + 2 * size, result);
+    }
+}
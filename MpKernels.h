@@ -0,0 +1,314 @@
+#pragma once
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+
+#if defined(__x86_64__) && defined(__GNUC__)
+/** Kernels using x86-64 instruction set extensions are compiled in (MpKernelsX86.cpp) */
+#define MP_INT_X86_KERNELS
+#endif
+
+/**
+ * @brief Kernels on magnitudes stored as arrays of 64-bit limbs (least significant first). Kernels are compiled
+ * in MpKernels.cpp (mpint library), so that they are built once. Hot kernels are called through a table, which is
+ * set at startup to the fastest variant supported by the processor (portable C++ otherwise, or always if
+ * environment variable MPINT_KERNELS is "portable"). Unless stated otherwise, result may alias first operand.
+ */
+class MpKernels {
+private:
+    /**
+     * @brief Inner structure with selected variants of hot kernels.
+     */
+    struct Table {
+        std::uint64_t (*addN)(std::uint64_t *, const std::uint64_t *, const std::uint64_t *, std::size_t);
+
+        std::uint64_t (*subN)(std::uint64_t *, const std::uint64_t *, const std::uint64_t *, std::size_t);
+
+        std::uint64_t (*mul1)(std::uint64_t *, const std::uint64_t *, std::size_t, std::uint64_t);
+
+        std::uint64_t (*addMul1)(std::uint64_t *, const std::uint64_t *, std::size_t, std::uint64_t);
+
+        std::uint64_t (*subMul1)(std::uint64_t *, const std::uint64_t *, std::size_t, std::uint64_t);
+
+        int (*compare)(const std::uint64_t *, const std::uint64_t *, std::size_t);
+
+        /** Description of selected variants */
+        const char *variant;
+    };
+
+public:
+    /**
+     * @brief Inner structure for invariant single-limb divisor with precomputed reciprocal (Moller, Granlund),
+     * division by it needs only multiplications. Constant divisors are prepared at compile time.
+     */
+    struct Divisor {
+        /** Divisor shifted left, so that its top bit is set */
+        std::uint64_t normalized;
+        /** Count of bits of shift */
+        int shift;
+        /** floor((2^128 - 1) / normalized) - 2^64 */
+        std::uint64_t reciprocal;
+
+        /**
+         * @param divisor Nonzero divisor.
+         */
+        constexpr explicit Divisor(std::uint64_t divisor)
+                : normalized(divisor << std::countl_zero(divisor)), shift(std::countl_zero(divisor)),
+                  reciprocal(static_cast<std::uint64_t>(~static_cast<unsigned __int128>(0) / normalized)) {
+        }
+
+        /**
+         * @return Divisor.
+         */
+        [[nodiscard]] constexpr std::uint64_t get() const {
+            return normalized >> shift;
+        }
+
+        /**
+         * @brief Remainder of two-limb number by one step of division with reciprocal.
+         * @param high Top limb, less than divisor.
+         * @param low Bottom limb.
+         * @return (high * 2^64 + low) mod divisor.
+         */
+        [[nodiscard]] constexpr std::uint64_t remainder(std::uint64_t high, std::uint64_t low) const {
+            if (shift != 0) {
+                high = (high << shift) | (low >> (64 - shift));
+                low <<= shift;
+            }
+            auto estimate = static_cast<unsigned __int128>(reciprocal) * high +
+                            ((static_cast<unsigned __int128>(high + 1) << 64) | low);
+            auto rest = low - static_cast<std::uint64_t>(estimate >> 64) * normalized;
+            if (rest > static_cast<std::uint64_t>(estimate)) {
+                rest += normalized;
+            }
+            if (rest >= normalized) {
+                rest -= normalized;
+            }
+            return rest >> shift;
+        }
+    };
+
+    // ------------------------------------------------------
+    // ------------------------------------------------------
+    // ------------------ VARIABLES -------------------------
+    // ------------------------------------------------------
+    // ------------------------------------------------------
+private:
+    /** Selected kernels, portable until selection at startup */
+    static Table table;
+    /** Selection of kernels at startup (value is unused) */
+    static const bool selected;
+
+    // ------------------------------------------------------
+    // ------------------------------------------------------
+    // ------------------ METHODS ---------------------------
+    // ------------------------------------------------------
+    // ------------------------------------------------------
+public:
+    /**
+     * @return Description of selected kernel variants, e.g. "adx+bmi2, avx512".
+     */
+    static const char *getVariant() {
+        return table.variant;
+    }
+
+    /**
+     * @brief result = a + b.
+     * @param size Count of limbs of a, b and result.
+     * @return Carry out of the top limb (0 or 1).
+     */
+    static std::uint64_t addN(std::uint64_t *result, const std::uint64_t *a, const std::uint64_t *b,
+                              std::size_t size) {
+        return table.addN(result, a, b, size);
+    }
+
+    /**
+     * @brief result = a + carry.
+     * @param size Count of limbs of a and result.
+     * @param carry Added limb.
+     * @return Carry out of the top limb (0 or 1).
+     */
+    static std::uint64_t add1(std::uint64_t *result, const std::uint64_t *a, std::size_t size, std::uint64_t carry);
+
+    /**
+     * @brief result = a - b.
+     * @param size Count of limbs of a, b and result.
+     * @return Borrow out of the top limb (0 or 1).
+     */
+    static std::uint64_t subN(std::uint64_t *result, const std::uint64_t *a, const std::uint64_t *b,
+                              std::size_t size) {
+        return table.subN(result, a, b, size);
+    }
+
+    /**
+     * @brief result = a - borrow.
+     * @param size Count of limbs of a and result.
+     * @param borrow Subtracted limb.
+     * @return Borrow out of the top limb (0 or 1).
+     */
+    static std::uint64_t sub1(std::uint64_t *result, const std::uint64_t *a, std::size_t size,
+                              std::uint64_t borrow);
+
+    /**
+     * @brief result = a * multiplier.
+     * @param size Count of limbs of a and result.
+     * @return Top limb of product.
+     */
+    static std::uint64_t mul1(std::uint64_t *result, const std::uint64_t *a, std::size_t size,
+                              std::uint64_t multiplier) {
+        return table.mul1(result, a, size, multiplier);
+    }
+
+    /**
+     * @brief result += a * multiplier. Result must not alias a.
+     * @param size Count of limbs of a and result.
+     * @return Carry limb out of the top limb.
+     */
+    static std::uint64_t addMul1(std::uint64_t *result, const std::uint64_t *a, std::size_t size,
+                                 std::uint64_t multiplier) {
+        return table.addMul1(result, a, size, multiplier);
+    }
+
+    /**
+     * @brief result -= a * multiplier. Result must not alias a.
+     * @param size Count of limbs of a and result.
+     * @return Borrow limb out of the top limb.
+     */
+    static std::uint64_t subMul1(std::uint64_t *result, const std::uint64_t *a, std::size_t size,
+                                 std::uint64_t multiplier) {
+        return table.subMul1(result, a, size, multiplier);
+    }
+
+    /**
+     * @brief result = a + b or a - b of two's complement numbers of different lengths. Value of number is
+     * sum of its limbs - 2^(64 * size) if it is negative (limbs above size are sign extension).
+     * @param result Array of max(aSize, bSize) limbs, may alias a or b.
+     * @param subtract True for a - b.
+     * @return Value t of limbs above result, so that a +- b = result + t * 2^(64 * max(aSize, bSize)), where t
+     * is -2, -1, 0 or 1.
+     */
+    static int addSigned(std::uint64_t *result, const std::uint64_t *a, std::size_t aSize, bool aNegative,
+                         const std::uint64_t *b, std::size_t bSize, bool bNegative, bool subtract);
+
+    /**
+     * @brief quotient = a / divisor.
+     * @param size Count of limbs of a and quotient.
+     * @param divisor Nonzero divisor.
+     * @return Remainder.
+     */
+    static std::uint64_t divRem1(std::uint64_t *quotient, const std::uint64_t *a, std::size_t size,
+                                 std::uint64_t divisor);
+
+    /**
+     * @brief quotient = a / divisor by multiplications with reciprocal.
+     * @param size Count of limbs of a and quotient.
+     * @return Remainder.
+     */
+    static std::uint64_t divRem1(std::uint64_t *quotient, const std::uint64_t *a, std::size_t size,
+                                 const Divisor &divisor);
+
+    /**
+     * @brief Remainder of a / divisor without quotient.
+     * @param size Count of limbs of a.
+     * @param divisor Nonzero divisor.
+     * @return Remainder.
+     */
+    static std::uint64_t mod1(const std::uint64_t *a, std::size_t size, std::uint64_t divisor);
+
+    /**
+     * @brief Remainder of a / divisor without quotient by multiplications with reciprocal.
+     * @param size Count of limbs of a.
+     * @return Remainder.
+     */
+    static std::uint64_t mod1(const std::uint64_t *a, std::size_t size, const Divisor &divisor);
+
+    /**
+     * @brief Compare magnitudes of equal size.
+     * @return Negative, zero or positive value as a is less, equal or greater than b.
+     */
+    static int compare(const std::uint64_t *a, const std::uint64_t *b, std::size_t size) {
+        return table.compare(a, b, size);
+    }
+
+    /**
+     * @brief result = a * b (schoolbook). Result must not alias operands.
+     * @param result Array of aSize + bSize limbs.
+     * @param aSize Count of limbs of a (at least 1).
+     * @param bSize Count of limbs of b (at least 1).
+     */
+    static void multiply(std::uint64_t *result, const std::uint64_t *a, std::size_t aSize, const std::uint64_t *b,
+                         std::size_t bSize);
+
+    /**
+     * @brief Long division (Knuth, Algorithm D). Outputs must not alias operands.
+     * @param quotient Array of aSize - bSize + 1 limbs.
+     * @param remainder Array of bSize limbs or nullptr.
+     * @param aSize Count of limbs of dividend (at least bSize).
+     * @param bSize Count of limbs of divisor (at least 2, top limb nonzero).
+     */
+    static void divRem(std::uint64_t *quotient, std::uint64_t *remainder, const std::uint64_t *a,
+                       std::size_t aSize, const std::uint64_t *b, std::size_t bSize);
+
+    /**
+     * @brief Montgomery product result = a * b / 2^(64 * size) mod m (interleaved reduction).
+     * @param a Operand less than m.
+     * @param b Operand less than m.
+     * @param m Odd modulus with nonzero top limb.
+     * @param size Count of limbs of a, b, m and result.
+     * @param inverse -m^(-1) mod 2^64.
+     * @param scratch Array of 2 * size + 1 limbs, must not alias other arguments.
+     */
+    static void montgomeryMultiply(std::uint64_t *result, const std::uint64_t *a, const std::uint64_t *b,
+                                   const std::uint64_t *m, std::size_t size, std::uint64_t inverse,
+                                   std::uint64_t *scratch);
+
+private:
+    /**
+     * @brief Set table to the fastest variants supported by the processor.
+     * @return True.
+     */
+    static bool select();
+
+    // portable variants (MpKernels.cpp)
+
+    static std::uint64_t addNPortable(std::uint64_t *result, const std::uint64_t *a, const std::uint64_t *b,
+                                      std::size_t size);
+
+    static std::uint64_t subNPortable(std::uint64_t *result, const std::uint64_t *a, const std::uint64_t *b,
+                                      std::size_t size);
+
+    static std::uint64_t mul1Portable(std::uint64_t *result, const std::uint64_t *a, std::size_t size,
+                                      std::uint64_t multiplier);
+
+    static std::uint64_t addMul1Portable(std::uint64_t *result, const std::uint64_t *a, std::size_t size,
+                                         std::uint64_t multiplier);
+
+    static std::uint64_t subMul1Portable(std::uint64_t *result, const std::uint64_t *a, std::size_t size,
+                                         std::uint64_t multiplier);
+
+    static int comparePortable(const std::uint64_t *a, const std::uint64_t *b, std::size_t size);
+
+#ifdef MP_INT_X86_KERNELS
+    // carry chains of ADX (adcx/adox) and products of BMI2 (mulx), vector comparisons (MpKernelsX86.cpp)
+
+    static std::uint64_t addNAdx(std::uint64_t *result, const std::uint64_t *a, const std::uint64_t *b,
+                                 std::size_t size);
+
+    static std::uint64_t subNAdx(std::uint64_t *result, const std::uint64_t *a, const std::uint64_t *b,
+                                 std::size_t size);
+
+    static std::uint64_t mul1Bmi2(std::uint64_t *result, const std::uint64_t *a, std::size_t size,
+                                  std::uint64_t multiplier);
+
+    static std::uint64_t addMul1Adx(std::uint64_t *result, const std::uint64_t *a, std::size_t size,
+                                    std::uint64_t multiplier);
+
+    static std::uint64_t subMul1Adx(std::uint64_t *result, const std::uint64_t *a, std::size_t size,
+                                    std::uint64_t multiplier);
+
+    static int compareAvx2(const std::uint64_t *a, const std::uint64_t *b, std::size_t size);
+
+    static int compareAvx512(const std::uint64_t *a, const std::uint64_t *b, std::size_t size);
+#endif
+};
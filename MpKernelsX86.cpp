@@ -0,0 +1,140 @@
+#include "MpKernels.h"
+
+#ifdef MP_INT_X86_KERNELS
+
+#include <immintrin.h>
+
+// Instruction sets are enabled per function by target attributes, so that the rest of the library stays portable
+// and the variants are selected by MpKernels::select() only on processors supporting them.
+
+__attribute__((target("adx,bmi2")))
+std::uint64_t MpKernels::addNAdx(std::uint64_t *result, const std::uint64_t *a, const std::uint64_t *b,
+                                 std::size_t size) {
+    unsigned char carry = 0;
+    unsigned long long r0, r1, r2, r3;
+    std::size_t i = 0;
+    for (; i + 4 <= size; i += 4) {
+        carry = _addcarryx_u64(carry, a[i], b[i], &r0);
+        carry = _addcarryx_u64(carry, a[i + 1], b[i + 1], &r1);
+        carry = _addcarryx_u64(carry, a[i + 2], b[i + 2], &r2);
+        carry = _addcarryx_u64(carry, a[i + 3], b[i + 3], &r3);
+        result[i] = r0;
+        result[i + 1] = r1;
+        result[i + 2] = r2;
+        result[i + 3] = r3;
+    }
+    for (; i < size; i++) {
+        carry = _addcarryx_u64(carry, a[i], b[i], &r0);
+        result[i] = r0;
+    }
+    return carry;
+}
+
+__attribute__((target("adx,bmi2")))
+std::uint64_t MpKernels::subNAdx(std::uint64_t *result, const std::uint64_t *a, const std::uint64_t *b,
+                                 std::size_t size) {
+    unsigned char borrow = 0;
+    unsigned long long r0, r1, r2, r3;
+    std::size_t i = 0;
+    for (; i + 4 <= size; i += 4) {
+        borrow = _subborrow_u64(borrow, a[i], b[i], &r0);
+        borrow = _subborrow_u64(borrow, a[i + 1], b[i + 1], &r1);
+        borrow = _subborrow_u64(borrow, a[i + 2], b[i + 2], &r2);
+        borrow = _subborrow_u64(borrow, a[i + 3], b[i + 3], &r3);
+        result[i] = r0;
+        result[i + 1] = r1;
+        result[i + 2] = r2;
+        result[i + 3] = r3;
+    }
+    for (; i < size; i++) {
+        borrow = _subborrow_u64(borrow, a[i], b[i], &r0);
+        result[i] = r0;
+    }
+    return borrow;
+}
+
+__attribute__((target("adx,bmi2")))
+std::uint64_t MpKernels::mul1Bmi2(std::uint64_t *result, const std::uint64_t *a, std::size_t size,
+                                  std::uint64_t multiplier) {
+    // low halves of products are added to high halves of previous products in one carry chain
+    unsigned char carry = 0;
+    unsigned long long high = 0, previous = 0, sum;
+    for (std::size_t i = 0; i < size; i++) {
+        auto low = _mulx_u64(a[i], multiplier, &high);
+        carry = _addcarryx_u64(carry, low, previous, &sum);
+        result[i] = sum;
+        previous = high;
+    }
+    return previous + carry;
+}
+
+__attribute__((target("adx,bmi2")))
+std::uint64_t MpKernels::addMul1Adx(std::uint64_t *result, const std::uint64_t *a, std::size_t size,
+                                    std::uint64_t multiplier) {
+    // two independent carry chains: products (adcx) and accumulation into result (adox)
+    unsigned char productCarry = 0, resultCarry = 0;
+    unsigned long long high = 0, previous = 0, product, sum;
+    for (std::size_t i = 0; i < size; i++) {
+        auto low = _mulx_u64(a[i], multiplier, &high);
+        productCarry = _addcarryx_u64(productCarry, low, previous, &product);
+        resultCarry = _addcarryx_u64(resultCarry, result[i], product, &sum);
+        result[i] = sum;
+        previous = high;
+    }
+    return previous + productCarry + resultCarry;
+}
+
+__attribute__((target("adx,bmi2")))
+std::uint64_t MpKernels::subMul1Adx(std::uint64_t *result, const std::uint64_t *a, std::size_t size,
+                                    std::uint64_t multiplier) {
+    unsigned char productCarry = 0, borrow = 0;
+    unsigned long long high = 0, previous = 0, product, difference;
+    for (std::size_t i = 0; i < size; i++) {
+        auto low = _mulx_u64(a[i], multiplier, &high);
+        productCarry = _addcarryx_u64(productCarry, low, previous, &product);
+        borrow = _subborrow_u64(borrow, result[i], product, &difference);
+        result[i] = difference;
+        previous = high;
+    }
+    return previous + productCarry + borrow;
+}
+
+__attribute__((target("avx2")))
+int MpKernels::compareAvx2(const std::uint64_t *a, const std::uint64_t *b, std::size_t size) {
+    // skip equal blocks of four limbs from the top, the differing limb is then found in the last block
+    auto i = size;
+    for (; i >= 4; i -= 4) {
+        auto x = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(a + i - 4));
+        auto y = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(b + i - 4));
+        if (_mm256_movemask_epi8(_mm256_cmpeq_epi64(x, y)) != -1) {
+            break;
+        }
+    }
+    while (i-- > 0) {
+        if (a[i] != b[i]) {
+            return a[i] < b[i] ? -1 : 1;
+        }
+    }
+    return 0;
+}
+
+__attribute__((target("avx512f")))
+int MpKernels::compareAvx512(const std::uint64_t *a, const std::uint64_t *b, std::size_t size) {
+    // skip equal blocks of eight limbs from the top, the differing limb is then found in the last block
+    auto i = size;
+    for (; i >= 8; i -= 8) {
+        auto x = _mm512_loadu_si512(a + i - 8);
+        auto y = _mm512_loadu_si512(b + i - 8);
+        if (_mm512_cmpneq_epu64_mask(x, y) != 0) {
+            break;
+        }
+    }
+    while (i-- > 0) {
+        if (a[i] != b[i]) {
+            return a[i] < b[i] ? -1 : 1;
+        }
+    }
+    return 0;
+}
+
+#endif
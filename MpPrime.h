@@ -0,0 +1,511 @@
+#pragma once
+
+#include "MpInt.h"
+#include <algorithm>
+#include <atomic>
+#include <future>
+#include <vector>
+
+/** Primes below this limit are used for trial division and sieving */
+constexpr std::uint64_t PRIME_TABLE_LIMIT = 1 << 16;
+/** Maximal count of numbers of one sieve window of next prime search */
+constexpr std::size_t PRIME_SIEVE_WINDOW = 1 << 16;
+/** Count of numbers of sieve window per bit of searched number (about 90 average prime gaps) */
+constexpr std::size_t PRIME_SIEVE_WINDOW_PER_BIT = 64;
+/** Count of Selfridge parameters tried before the number is checked to be a perfect square */
+constexpr int PRIME_SQUARE_CHECK = 8;
+
+/**
+ * @brief Probable prime testing and prime search. Test is Baillie-PSW: trial division by table of small primes,
+ * strong probable prime test to base 2 (Miller-Rabin) and strong Lucas probable prime test with Selfridge
+ * parameters, modular arithmetic is in Montgomery form. No composite passing Baillie-PSW is known.
+ */
+class MpPrime {
+    // ------------------------------------------------------
+    // ------------------------------------------------------
+    // ------------------ INNER CLASSES ---------------------
+    // ------------------------------------------------------
+    // ------------------------------------------------------
+private:
+    /**
+     * @brief Arithmetic modulo odd number in Montgomery form, residue x is stored as x * 2^(64 * size) mod modulus in
+     * size limbs.
+     */
+    class Montgomery {
+    private:
+        /** Odd modulus with nonzero top limb */
+        const magnitudeStorage &modulus;
+        /** -modulus^(-1) mod 2^64 */
+        std::uint64_t inverse;
+        /** 2^(128 * size) mod modulus, multiplication by it converts to Montgomery form */
+        magnitudeStorage square;
+        /** Scratch of products */
+        magnitudeStorage scratch;
+    public:
+        /** Montgomery form of 1 */
+        magnitudeStorage one;
+
+        /**
+         * @param modulus Odd modulus greater than 1 without leading zero limbs (must outlive this).
+         */
+        explicit Montgomery(const magnitudeStorage &modulus) : modulus(modulus), scratch(2 * modulus.size() + 1) {
+            // modulus is its own inverse modulo 8, every Newton step doubles count of correct bits
+            inverse = modulus[0];
+            for (int i = 0; i < 5; i++) {
+                inverse *= 2 - modulus[0] * inverse;
+            }
+            inverse = 0 - inverse;
+            auto size = modulus.size();
+            magnitudeStorage power(2 * size + 1, 0);
+            power[2 * size] = 1;
+            square.resize(size);
+            if (size == 1) {
+                square[0] = MpKernels::mod1(power.data(), power.size(), modulus[0]);
+            } else {
+                magnitudeStorage quotient(size + 2);
+                MpKernels::divRem(quotient.data(), square.data(), power.data(), power.size(), modulus.data(), size);
+            }
+            one = fromSigned(1);
+        }
+
+        /**
+         * @return Montgomery form of small signed number.
+         */
+        magnitudeStorage fromSigned(long long value) {
+            magnitudeStorage result(modulus.size(), 0);
+            auto magnitude = value < 0 ? 0 - static_cast<std::uint64_t>(value) : static_cast<std::uint64_t>(value);
+            result[0] = modulus.size() == 1 ? magnitude % modulus[0] : magnitude;
+            if (value < 0 && !isZero(result)) {
+                MpKernels::subN(result.data(), modulus.data(), result.data(), result.size());
+            }
+            multiply(result, result, square);
+            return result;
+        }
+
+        /**
+         * @brief result = a * b.
+         */
+        void multiply(magnitudeStorage &result, const magnitudeStorage &a, const magnitudeStorage &b) {
+            MpKernels::montgomeryMultiply(result.data(), a.data(), b.data(), modulus.data(), modulus.size(), inverse,
+                                          scratch.data());
+        }
+
+        /**
+         * @brief result = a + b.
+         */
+        void add(magnitudeStorage &result, const magnitudeStorage &a, const magnitudeStorage &b) const {
+            auto carry = MpKernels::addN(result.data(), a.data(), b.data(), result.size());
+            if (carry != 0 || MpKernels::compare(result.data(), modulus.data(), result.size()) >= 0) {
+                MpKernels::subN(result.data(), result.data(), modulus.data(), result.size());
+            }
+        }
+
+        /**
+         * @brief result = a - b.
+         */
+        void subtract(magnitudeStorage &result, const magnitudeStorage &a, const magnitudeStorage &b) const {
+            if (MpKernels::subN(result.data(), a.data(), b.data(), result.size()) != 0) {
+                MpKernels::addN(result.data(), result.data(), modulus.data(), result.size());
+            }
+        }
+
+        /**
+         * @brief value = value / 2.
+         */
+        void half(magnitudeStorage &value) const {
+            std::uint64_t carry = 0;
+            if ((value[0] & 1) != 0) {
+                carry = MpKernels::addN(value.data(), value.data(), modulus.data(), value.size());
+            }
+            for (std::size_t i = 0; i < value.size(); i++) {
+                auto next = i + 1 < value.size() ? value[i + 1] : carry;
+                value[i] = (value[i] >> 1) | (next << 63);
+            }
+        }
+
+        /**
+         * @return base^exponent.
+         */
+        magnitudeStorage power(const magnitudeStorage &base, const magnitudeStorage &exponent) {
+            auto result = base;
+            for (auto bit = MpInt<MP_INT_UNLIMITED>::getBitLength(exponent) - 1; bit-- > 0;) {
+                MpProgress::checkpoint();
+                multiply(result, result, result);
+                if ((exponent[bit / ELEMENT_BIT_SIZE] >> (bit % ELEMENT_BIT_SIZE) & 1) != 0) {
+                    multiply(result, result, base);
+                }
+            }
+            return result;
+        }
+
+        /**
+         * @return True if value is zero.
+         */
+        [[nodiscard]] static bool isZero(const magnitudeStorage &value) {
+            return std::all_of(value.begin(), value.end(), [](auto word) { return word == 0; });
+        }
+    };
+
+    // ------------------------------------------------------
+    // ------------------------------------------------------
+    // ------------------ METHODS ---------------------------
+    // ------------------------------------------------------
+    // ------------------------------------------------------
+public:
+    /**
+     * @brief Test if number is probable prime (Baillie-PSW).
+     * @param value Tested number of any precision, negative numbers are not primes.
+     * @param rounds Count of additional Miller-Rabin rounds with bases 3, 5, 7, ...
+     * @return True if value is (probable) prime, false if it is surely composite (or less than 2).
+     */
+    template<std::size_t bytePrecision>
+    static bool isProbablePrime(const MpInt<bytePrecision> &value, unsigned rounds = 0) {
+        if (value.isNegative()) {
+            return false;
+        }
+        auto magnitude = value.getMagnitude();
+        if (magnitude.empty()) {
+            return false;
+        }
+        const auto &primes = getPrimes();
+        if (magnitude.size() == 1 && magnitude[0] < PRIME_TABLE_LIMIT) {
+            return std::binary_search(primes.begin(), primes.end(), magnitude[0]);
+        }
+        if (hasSmallFactor(magnitude)) {
+            return false;
+        }
+        if (magnitude.size() == 1 && magnitude[0] < PRIME_TABLE_LIMIT * PRIME_TABLE_LIMIT) {
+            return true;
+        }
+        return isBailliePsw(magnitude, rounds);
+    }
+
+    /**
+     * @brief Find smallest probable prime greater than value. Numbers of window are sieved by table of small primes,
+     * remaining candidates are tested in parallel. Throw MpIntException if number limitation is overflowed.
+     * @param value Number of any precision.
+     * @return Next prime.
+     */
+    template<std::size_t bytePrecision>
+    static MpInt<bytePrecision> nextPrime(const MpInt<bytePrecision> &value) {
+        MpProgress::Scope progress("prvocislo");
+        const auto &primes = getPrimes();
+        auto start = value.isNegative() ? magnitudeStorage() : value.getMagnitude();
+        if (start.empty() || (start.size() == 1 && start[0] < primes.back())) {
+            auto prime = start.empty() ? primes.front() : *std::upper_bound(primes.begin(), primes.end(), start[0]);
+            return MpInt<bytePrecision>::fromMagnitude(magnitudeStorage{prime}, false);
+        }
+        start = addWord(start, 1);
+        auto size = std::min(PRIME_SIEVE_WINDOW,
+                             MpInt<MP_INT_UNLIMITED>::getBitLength(start) * PRIME_SIEVE_WINDOW_PER_BIT);
+        std::vector<bool> composite(size);
+        for (std::size_t window = 0;; window++) {
+            // start is above all table primes, so every marked number is a proper multiple
+            composite.assign(size, false);
+            for (auto prime: primes) {
+                auto remainder = MpKernels::mod1(start.data(), start.size(), prime);
+                for (auto i = remainder == 0 ? 0 : prime - remainder; i < size; i += prime) {
+                    composite[i] = true;
+                }
+            }
+            std::vector<std::uint64_t> candidates;
+            for (std::size_t i = 0; i < size; i++) {
+                if (!composite[i]) {
+                    candidates.push_back(i);
+                }
+            }
+            auto found = findFirstPrime(start, candidates);
+            if (found < candidates.size()) {
+                return MpInt<bytePrecision>::fromMagnitude(addWord(start, candidates[found]), false);
+            }
+            start = addWord(start, size);
+            progress.report(window + 1, 0);
+        }
+    }
+
+    /**
+     * @return Ascending primes below limit (sieve of Eratosthenes).
+     */
+    static std::vector<std::uint64_t> getPrimesBelow(std::uint64_t limit) {
+        std::vector<bool> composite(limit);
+        std::vector<std::uint64_t> primes;
+        for (std::uint64_t i = 2; i < limit; i++) {
+            if (!composite[i]) {
+                primes.push_back(i);
+                for (auto j = i * i; j < limit; j += i) {
+                    composite[j] = true;
+                }
+            }
+        }
+        return primes;
+    }
+
+private:
+    /**
+     * @return Ascending primes below PRIME_TABLE_LIMIT (computed on first use).
+     */
+    static const std::vector<std::uint64_t> &getPrimes() {
+        static const std::vector<std::uint64_t> primes = getPrimesBelow(PRIME_TABLE_LIMIT);
+        return primes;
+    }
+
+    /**
+     * @return Products of consecutive table primes fitting one word with index of first prime after each product.
+     */
+    static const std::vector<std::pair<std::uint64_t, std::size_t>> &getPrimeProducts() {
+        static const std::vector<std::pair<std::uint64_t, std::size_t>> products = [] {
+            const auto &primes = getPrimes();
+            std::vector<std::pair<std::uint64_t, std::size_t>> result;
+            std::uint64_t product = 1;
+            for (std::size_t i = 0; i < primes.size(); i++) {
+                if (product > UINT64_MAX / primes[i]) {
+                    result.emplace_back(product, i);
+                    product = 1;
+                }
+                product *= primes[i];
+            }
+            result.emplace_back(product, primes.size());
+            return result;
+        }();
+        return products;
+    }
+
+    /**
+     * @brief Trial division by table primes, one big-by-word remainder for every product of primes.
+     * @param magnitude Number greater than all table primes.
+     * @return True if number is divisible by a table prime.
+     */
+    static bool hasSmallFactor(const magnitudeStorage &magnitude) {
+        const auto &primes = getPrimes();
+        std::size_t first = 0;
+        for (auto [product, last]: getPrimeProducts()) {
+            auto remainder = MpKernels::mod1(magnitude.data(), magnitude.size(), product);
+            for (auto i = first; i < last; i++) {
+                if (remainder % primes[i] == 0) {
+                    return true;
+                }
+            }
+            first = last;
+        }
+        return false;
+    }
+
+    /**
+     * @brief Baillie-PSW test of odd number without small factors.
+     * @param rounds Count of additional Miller-Rabin rounds.
+     */
+    static bool isBailliePsw(const magnitudeStorage &magnitude, unsigned rounds) {
+        Montgomery montgomery(magnitude);
+        if (!isStrongProbablePrime(montgomery, magnitude, 2)) {
+            return false;
+        }
+        const auto &primes = getPrimes();
+        for (unsigned i = 0; i < rounds && i + 1 < primes.size(); i++) {
+            if (!isStrongProbablePrime(montgomery, magnitude, primes[i + 1])) {
+                return false;
+            }
+        }
+        return isStrongLucasProbablePrime(montgomery, magnitude);
+    }
+
+    /**
+     * @brief Miller-Rabin test: for n - 1 = d * 2^s, base^d = 1 or base^(d * 2^r) = -1 for some r < s.
+     */
+    static bool isStrongProbablePrime(Montgomery &montgomery, const magnitudeStorage &magnitude,
+                                      std::uint64_t base) {
+        auto exponent = magnitude;
+        MpKernels::sub1(exponent.data(), exponent.data(), exponent.size(), 1);
+        auto shift = shiftOutZeros(exponent);
+        auto minusOne = montgomery.one;
+        montgomery.subtract(minusOne, magnitudeStorage(magnitude.size(), 0), montgomery.one);
+        auto power = montgomery.power(montgomery.fromSigned(static_cast<long long>(base)), exponent);
+        if (power == montgomery.one || power == minusOne) {
+            return true;
+        }
+        for (std::size_t r = 1; r < shift; r++) {
+            montgomery.multiply(power, power, power);
+            if (power == minusOne) {
+                return true;
+            }
+            if (power == montgomery.one) {
+                return false;
+            }
+        }
+        return false;
+    }
+
+    /**
+     * @brief Strong Lucas test with Selfridge parameters: D is first of 5, -7, 9, -11, ... with Jacobi symbol
+     * (D / n) = -1, P = 1 and Q = (1 - D) / 4. For n + 1 = d * 2^s, U(d) = 0 or V(d * 2^r) = 0 for some r < s.
+     */
+    static bool isStrongLucasProbablePrime(Montgomery &montgomery, const magnitudeStorage &magnitude) {
+        long long d = 5;
+        for (int attempt = 1;; attempt++) {
+            auto jacobi = getJacobi(d, magnitude);
+            if (jacobi == -1) {
+                break;
+            }
+            // numbers without small factors share no factor with D, squares have no parameter with symbol -1
+            if (jacobi == 0 || (attempt == PRIME_SQUARE_CHECK && isSquare(magnitude))) {
+                return false;
+            }
+            d = d > 0 ? -d - 2 : -d + 2;
+        }
+        auto exponent = addWord(magnitude, 1);
+        auto shift = shiftOutZeros(exponent);
+        auto q = montgomery.fromSigned((1 - d) / 4);
+        auto dForm = montgomery.fromSigned(d);
+        // U(1) = 1, V(1) = P = 1, Q^1 = Q
+        auto u = montgomery.one;
+        auto v = montgomery.one;
+        auto qPower = q;
+        auto temporary = u;
+        for (auto bit = MpInt<MP_INT_UNLIMITED>::getBitLength(exponent) - 1; bit-- > 0;) {
+            MpProgress::checkpoint();
+            // U(2k) = U(k) V(k), V(2k) = V(k)^2 - 2 Q^k
+            montgomery.multiply(u, u, v);
+            montgomery.multiply(v, v, v);
+            montgomery.subtract(v, v, qPower);
+            montgomery.subtract(v, v, qPower);
+            montgomery.multiply(qPower, qPower, qPower);
+            if ((exponent[bit / ELEMENT_BIT_SIZE] >> (bit % ELEMENT_BIT_SIZE) & 1) != 0) {
+                // U(k + 1) = (P U(k) + V(k)) / 2, V(k + 1) = (D U(k) + P V(k)) / 2
+                montgomery.multiply(temporary, dForm, u);
+                montgomery.add(u, u, v);
+                montgomery.half(u);
+                montgomery.add(v, temporary, v);
+                montgomery.half(v);
+                montgomery.multiply(qPower, qPower, q);
+            }
+        }
+        if (Montgomery::isZero(u) || Montgomery::isZero(v)) {
+            return true;
+        }
+        for (std::size_t r = 1; r < shift; r++) {
+            montgomery.multiply(v, v, v);
+            montgomery.subtract(v, v, qPower);
+            montgomery.subtract(v, v, qPower);
+            if (Montgomery::isZero(v)) {
+                return true;
+            }
+            montgomery.multiply(qPower, qPower, qPower);
+        }
+        return false;
+    }
+
+    /**
+     * @return Jacobi symbol (d / n) of odd small d and odd number n greater than |d|.
+     */
+    static int getJacobi(long long d, const magnitudeStorage &n) {
+        int result = 1;
+        if (d < 0) {
+            d = -d;
+            // (-1 / n) = -1 for n = 3 (mod 4)
+            if ((n[0] & 3) == 3) {
+                result = -result;
+            }
+        }
+        auto a = static_cast<std::uint64_t>(d);
+        // reciprocity of odd numbers, then symbol of words
+        if ((a & 3) == 3 && (n[0] & 3) == 3) {
+            result = -result;
+        }
+        auto b = MpKernels::mod1(n.data(), n.size(), a);
+        while (b != 0) {
+            while ((b & 1) == 0) {
+                b >>= 1;
+                if ((a & 7) == 3 || (a & 7) == 5) {
+                    result = -result;
+                }
+            }
+            std::swap(a, b);
+            if ((a & 3) == 3 && (b & 3) == 3) {
+                result = -result;
+            }
+            b %= a;
+        }
+        return a == 1 ? result : 0;
+    }
+
+    /**
+     * @return True if number is a perfect square.
+     */
+    static bool isSquare(const magnitudeStorage &magnitude) {
+        auto root = MpInt<MP_INT_UNLIMITED>::sqrtMagnitude(magnitude);
+        return MpInt<MP_INT_UNLIMITED>::multiplyMagnitudes(root, root) == magnitude;
+    }
+
+    /**
+     * @brief Test candidates start + offset in parallel. Threads take candidates in ascending order and stop after
+     * the smallest prime found so far, so all candidates before the returned one were tested.
+     * @return Index of first prime candidate or count of candidates if there is none.
+     */
+    static std::size_t findFirstPrime(const magnitudeStorage &start, const std::vector<std::uint64_t> &candidates) {
+        std::atomic<std::size_t> next = 0;
+        std::atomic<std::size_t> found = candidates.size();
+        auto test = [&] {
+            for (auto i = next++; i < found; i = next++) {
+                if (isBailliePsw(addWord(start, candidates[i]), 0)) {
+                    auto current = found.load();
+                    while (i < current && !found.compare_exchange_weak(current, i)) {
+                    }
+                }
+            }
+        };
+        std::vector<std::future<void>> helpers;
+        for (unsigned i = 1; i < std::min<std::size_t>(MpProgress::getThreads(), candidates.size()); i++) {
+            helpers.push_back(MpProgress::launch(test));
+        }
+        test();
+        for (auto &helper: helpers) {
+            helper.get();
+        }
+        return found;
+    }
+
+    /**
+     * @return Magnitude + word.
+     */
+    static magnitudeStorage addWord(const magnitudeStorage &magnitude, std::uint64_t word) {
+        magnitudeStorage result(magnitude.size() + 1, 0);
+        if (magnitude.empty()) {
+            result[0] = word;
+        } else {
+            result.back() = MpKernels::add1(result.data(), magnitude.data(), magnitude.size(), word);
+        }
+        if (result.back() == 0) {
+            result.pop_back();
+        }
+        return result;
+    }
+
+    /**
+     * @brief Shift out trailing zero bits of nonzero magnitude.
+     * @return Count of shifted bits.
+     */
+    static std::size_t shiftOutZeros(magnitudeStorage &magnitude) {
+        std::size_t limbs = 0;
+        while (magnitude[limbs] == 0) {
+            limbs++;
+        }
+        magnitude.erase(magnitude.begin(), magnitude.begin() + static_cast<std::ptrdiff_t>(limbs));
+        auto bits = static_cast<unsigned>(std::countr_zero(magnitude[0]));
+        shiftRight(magnitude, bits);
+        return limbs * ELEMENT_BIT_SIZE + bits;
+    }
+
+    /**
+     * @brief Shift magnitude right by less than one word and drop leading zero limbs.
+     */
+    static void shiftRight(magnitudeStorage &magnitude, unsigned bits) {
+        if (bits != 0) {
+            for (std::size_t i = 0; i < magnitude.size(); i++) {
+                auto next = i + 1 < magnitude.size() ? magnitude[i + 1] : 0;
+                magnitude[i] = (magnitude[i] >> bits) | (next << (ELEMENT_BIT_SIZE - bits));
+            }
+        }
+        while (!magnitude.empty() && magnitude.back() == 0) {
+            magnitude.pop_back();
+        }
+    }
+};
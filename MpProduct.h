@@ -0,0 +1,166 @@
+#pragma once
+
+#include "MpInt.h"
+#include <algorithm>
+#include <concepts>
+#include <future>
+#include <ranges>
+#include <vector>
+
+/** Minimal count of limbs of a subtree whose halves are multiplied in parallel */
+constexpr std::size_t PRODUCT_PARALLEL_LIMBS = 4096;
+
+/**
+ * @brief Order of multiplication of product tree.
+ */
+enum class MpProductOrder {
+    /** Balanced tree over factors in given order, upper levels run in parallel */
+    BALANCED,
+    /** Always multiply two smallest partial products (Huffman), better for factors of very different sizes */
+    HUFFMAN
+};
+
+/**
+ * @brief Product of many numbers by a product tree. Consecutive factors fitting one word are multiplied into
+ * word-sized leaves first, then leaves are multiplied by the same magnitude multiplication as operator*.
+ */
+class MpProduct {
+    // ------------------------------------------------------
+    // ------------------------------------------------------
+    // ------------------ METHODS ---------------------------
+    // ------------------------------------------------------
+    // ------------------------------------------------------
+public:
+    /**
+     * @brief Multiply all numbers of range. Throw MpIntException if number limitation is overflowed (only the
+     * final product is checked) or MpIntOverflowPredicted before any work if overflow is certain and large.
+     * @tparam bytePrecision Precision of result.
+     * @param values Range of MpInt of any precision or of native integers.
+     * @param order Order of multiplication.
+     * @return Product of values, 1 for empty range.
+     */
+    template<std::size_t bytePrecision = MP_INT_UNLIMITED, std::ranges::input_range Range>
+    static MpInt<bytePrecision> product(const Range &values, MpProductOrder order = MpProductOrder::BALANCED) {
+        MpStats::Timer timer(MpStatsOperation::MULTIPLY, 0);
+        MpProgress::Scope progress("soucin");
+        std::vector<magnitudeStorage> leaves;
+        bool negative = false;
+        std::uint64_t word = 1;
+        for (const auto &value: values) {
+            auto [magnitude, sign] = getMagnitude(value);
+            if (magnitude.empty()) {
+                return MpInt<bytePrecision>();
+            }
+            negative = negative != sign;
+            if (magnitude.size() == 1) {
+                auto leaf = static_cast<unsigned __int128>(word) * magnitude[0];
+                if ((leaf >> 64) == 0) {
+                    word = static_cast<std::uint64_t>(leaf);
+                    continue;
+                }
+                std::swap(word, magnitude[0]);
+            }
+            leaves.push_back(std::move(magnitude));
+        }
+        if (word != 1 || leaves.empty()) {
+            leaves.push_back(magnitudeStorage{word});
+        }
+        if constexpr (bytePrecision != MP_INT_UNLIMITED) {
+            // product of factors with bit lengths l1, l2, ... has at least l1 + l2 + ... - (count - 1) bits
+            std::size_t minimalBits = 1;
+            for (const auto &leaf: leaves) {
+                minimalBits += MpInt<bytePrecision>::getBitLength(leaf) - 1;
+            }
+            MpInt<bytePrecision>::checkPredictedOverflow(minimalBits);
+        }
+        auto result = order == MpProductOrder::HUFFMAN ? multiplyHuffman(leaves, progress)
+                                                       : multiplyBalanced(leaves, 0, leaves.size(), 1);
+        timer.setSize(result.size() * ELEMENT_BIT_SIZE);
+        return MpInt<bytePrecision>::fromMagnitude(std::move(result), negative);
+    }
+
+private:
+    /**
+     * @return Magnitude and sign of number.
+     */
+    template<std::size_t bytePrecision>
+    static std::pair<magnitudeStorage, bool> getMagnitude(const MpInt<bytePrecision> &value) {
+        return {value.getMagnitude(), value.isNegative()};
+    }
+
+    /**
+     * @return Magnitude and sign of native integer.
+     */
+    template<std::integral Integer>
+    static std::pair<magnitudeStorage, bool> getMagnitude(Integer value) {
+        auto magnitude = static_cast<std::uint64_t>(value);
+        bool negative = false;
+        if constexpr (std::is_signed_v<Integer>) {
+            if (value < 0) {
+                magnitude = 0 - magnitude;
+                negative = true;
+            }
+        }
+        return {magnitude == 0 ? magnitudeStorage() : magnitudeStorage{magnitude}, negative};
+    }
+
+    /**
+     * @brief Multiply leaves of balanced subtree. Halves of large subtrees run in parallel (MpProgress::launch)
+     * while there are threads left.
+     * @param leaves All leaves, consumed leaves are moved out.
+     * @param first First leaf of subtree.
+     * @param last Leaf after subtree.
+     * @param width Count of subtrees computed in parallel at this level.
+     * @return Product of subtree.
+     */
+    static magnitudeStorage multiplyBalanced(std::vector<magnitudeStorage> &leaves, std::size_t first,
+                                             std::size_t last, unsigned width) {
+        if (last - first == 1) {
+            return std::move(leaves[first]);
+        }
+        auto middle = first + (last - first) / 2;
+        if (width * 2 <= MpProgress::getThreads() && isLarge(leaves, first, last)) {
+            auto left = MpProgress::launch([&leaves, first, middle, width] {
+                return multiplyBalanced(leaves, first, middle, width * 2);
+            });
+            auto right = multiplyBalanced(leaves, middle, last, width * 2);
+            return MpInt<MP_INT_UNLIMITED>::multiplyMagnitudes(left.get(), right);
+        }
+        auto left = multiplyBalanced(leaves, first, middle, width);
+        auto right = multiplyBalanced(leaves, middle, last, width);
+        return MpInt<MP_INT_UNLIMITED>::multiplyMagnitudes(left, right);
+    }
+
+    /**
+     * @return True if leaves of subtree are large enough for parallel multiplication.
+     */
+    static bool isLarge(const std::vector<magnitudeStorage> &leaves, std::size_t first, std::size_t last) {
+        std::size_t limbs = 0;
+        for (auto i = first; i < last && limbs < PRODUCT_PARALLEL_LIMBS; i++) {
+            limbs += leaves[i].size();
+        }
+        return limbs >= PRODUCT_PARALLEL_LIMBS;
+    }
+
+    /**
+     * @brief Multiply leaves always taking two smallest partial products.
+     * @param leaves All leaves, moved out.
+     * @param progress Progress of product (reports count of multiplications).
+     * @return Product of leaves.
+     */
+    static magnitudeStorage multiplyHuffman(std::vector<magnitudeStorage> &leaves, MpProgress::Scope &progress) {
+        auto larger = [](const magnitudeStorage &a, const magnitudeStorage &b) { return a.size() > b.size(); };
+        std::make_heap(leaves.begin(), leaves.end(), larger);
+        auto total = leaves.size() - 1;
+        while (leaves.size() > 1) {
+            std::pop_heap(leaves.begin(), leaves.end(), larger);
+            auto a = std::move(leaves.back());
+            leaves.pop_back();
+            std::pop_heap(leaves.begin(), leaves.end(), larger);
+            leaves.back() = MpInt<MP_INT_UNLIMITED>::multiplyMagnitudes(a, leaves.back());
+            std::push_heap(leaves.begin(), leaves.end(), larger);
+            progress.report(total - leaves.size() + 1, total);
+        }
+        return std::move(leaves.front());
+    }
+};
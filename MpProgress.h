@@ -0,0 +1,276 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <exception>
+#include <future>
+#include <optional>
+#include <thread>
+#include <type_traits>
+
+/**
+ * @brief Count of checkpoints between two deadline checks.
+ */
+constexpr std::size_t DEADLINE_CHECK_INTERVAL = 64;
+
+/**
+ * @brief Exception thrown from inside of MpInt operations when computation is cancelled or its deadline passed.
+ */
+class MpIntCancelled : public std::exception {
+public:
+    /** True if deadline passed, false if computation was cancelled */
+    const bool timeout;
+
+    explicit MpIntCancelled(bool timeout) : timeout(timeout) {
+    }
+
+    [[nodiscard]] const char *what() const noexcept override {
+        return timeout ? "Computation timed out." : "Computation cancelled.";
+    }
+};
+
+/**
+ * @brief Cooperative cancellation and progress of long running MpInt computation. Progress is installed for
+ * the computing thread by Installer; MpInt loops then call checkpoint(), which costs one thread-local load when
+ * no progress is installed. Other threads may read progress and cancel the computation.
+ */
+class MpProgress {
+    // ------------------------------------------------------
+    // ------------------------------------------------------
+    // ------------------ VARIABLES -------------------------
+    // ------------------------------------------------------
+    // ------------------------------------------------------
+private:
+    /** Progress installed for current thread */
+    static inline thread_local MpProgress *current = nullptr;
+    /** Count of threads of parallel operations in whole process, including the calling threads */
+    static inline std::atomic<unsigned> threads = std::max(1u, std::thread::hardware_concurrency());
+    /** Count of running helper threads of parallel operations */
+    static inline std::atomic<unsigned> helpers = 0;
+
+    /** Cancellation request */
+    std::atomic<bool> cancelled = false;
+    /** Count of passed checkpoints */
+    std::atomic<std::size_t> steps = 0;
+    /** Finished work of outermost operation */
+    std::atomic<std::size_t> done = 0;
+    /** Total work of outermost operation, zero if unknown */
+    std::atomic<std::size_t> total = 0;
+    /** Name of outermost operation */
+    std::atomic<const char *> operation = nullptr;
+    /** Nesting of operations, helper threads of parallel operations nest below the computing thread */
+    std::atomic<std::size_t> depth = 0;
+    /** Time after which computation is cancelled */
+    std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::time_point::max();
+
+    // ------------------------------------------------------
+    // ------------------------------------------------------
+    // ------------------ INNER CLASSES ---------------------
+    // ------------------------------------------------------
+    // ------------------------------------------------------
+public:
+    /**
+     * @brief RAII installation of progress for current thread.
+     */
+    class Installer {
+    private:
+        /** Previously installed progress */
+        MpProgress *previous;
+    public:
+        explicit Installer(MpProgress &progress) : previous(current) {
+            current = &progress;
+        }
+
+        ~Installer() {
+            current = previous;
+        }
+
+        Installer(const Installer &) = delete;
+
+        Installer &operator=(const Installer &) = delete;
+    };
+
+private:
+    /**
+     * @brief RAII release of helper thread of launch().
+     */
+    struct HelperRelease {
+        ~HelperRelease() {
+            helpers--;
+        }
+    };
+
+public:
+
+    /**
+     * @brief RAII marker of long operation. Only the outermost operation reports its progress.
+     */
+    class Scope {
+    private:
+        /** Progress of current thread or nullptr */
+        MpProgress *progress;
+        /** True if this is the outermost operation */
+        bool outermost = false;
+    public:
+        /**
+         * @param name Name of operation (string literal).
+         */
+        explicit Scope(const char *name) : progress(current) {
+            if (progress != nullptr && progress->depth++ == 0) {
+                outermost = true;
+                progress->operation = name;
+                progress->done = 0;
+                progress->total = 0;
+            }
+        }
+
+        ~Scope() {
+            if (progress != nullptr) {
+                progress->depth--;
+            }
+        }
+
+        Scope(const Scope &) = delete;
+
+        Scope &operator=(const Scope &) = delete;
+
+        /**
+         * @brief Report progress of operation.
+         * @param finished Finished work.
+         * @param all Total work, zero if unknown.
+         */
+        void report(std::size_t finished, std::size_t all) {
+            if (outermost) {
+                progress->done.store(finished, std::memory_order_relaxed);
+                progress->total.store(all, std::memory_order_relaxed);
+            }
+        }
+    };
+
+    // ------------------------------------------------------
+    // ------------------------------------------------------
+    // ------------------ METHODS ---------------------------
+    // ------------------------------------------------------
+    // ------------------------------------------------------
+public:
+    /**
+     * @brief Cancellation point of long loops. Throw MpIntCancelled if computation of current thread is cancelled
+     * or its deadline passed.
+     */
+    static void checkpoint() {
+        if (current != nullptr) {
+            current->check();
+        }
+    }
+
+    /**
+     * @return Progress installed for current thread or nullptr. Helper threads of a computation install it too,
+     * so that they are cancelled with it.
+     */
+    static MpProgress *getCurrent() {
+        return current;
+    }
+
+    /**
+     * @brief Set count of threads of parallel operations in whole process (default is count of processors).
+     */
+    static void setThreads(unsigned count) {
+        threads = std::max(1u, count);
+    }
+
+    /**
+     * @return Count of threads of parallel operations in whole process.
+     */
+    static unsigned getThreads() {
+        return threads.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Run work on helper thread which shares progress (cancellation) of the calling thread. When all
+     * getThreads() - 1 helper threads of the process are busy, work is deferred and runs in the calling thread on
+     * get(), so nested and concurrent parallel operations never exceed the thread budget.
+     * @param work Callable without arguments.
+     * @return Future of result of work.
+     */
+    template<class Work>
+    static std::future<std::invoke_result_t<std::decay_t<Work>>> launch(Work &&work) {
+        auto running = helpers.load();
+        do {
+            if (running + 1 >= getThreads()) {
+                return std::async(std::launch::deferred, std::forward<Work>(work));
+            }
+        } while (!helpers.compare_exchange_weak(running, running + 1));
+        try {
+            return std::async(std::launch::async, [progress = current, work = std::forward<Work>(work)]() mutable {
+                HelperRelease release;
+                std::optional<Installer> installer;
+                if (progress != nullptr) {
+                    installer.emplace(*progress);
+                }
+                return work();
+            });
+        } catch (...) {
+            helpers--;
+            throw;
+        }
+    }
+
+    /**
+     * @brief Request cancellation. Can be called from any thread.
+     */
+    void cancel() {
+        cancelled = true;
+    }
+
+    /**
+     * @brief Set deadline of computation. Must be called before computation starts.
+     */
+    void setDeadline(std::chrono::steady_clock::time_point time) {
+        deadline = time;
+    }
+
+    /**
+     * @return Count of passed checkpoints.
+     */
+    [[nodiscard]] std::size_t getSteps() const {
+        return steps.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @return Finished work of outermost operation.
+     */
+    [[nodiscard]] std::size_t getDone() const {
+        return done.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @return Total work of outermost operation, zero if unknown.
+     */
+    [[nodiscard]] std::size_t getTotal() const {
+        return total.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @return Name of outermost operation or nullptr.
+     */
+    [[nodiscard]] const char *getOperation() const {
+        return operation.load();
+    }
+
+private:
+    /**
+     * @brief Count checkpoint and check cancellation.
+     */
+    void check() {
+        auto count = steps.load(std::memory_order_relaxed) + 1;
+        steps.store(count, std::memory_order_relaxed);
+        if (cancelled.load(std::memory_order_relaxed)) {
+            throw MpIntCancelled(false);
+        }
+        if (count % DEADLINE_CHECK_INTERVAL == 0 && std::chrono::steady_clock::now() >= deadline) {
+            throw MpIntCancelled(true);
+        }
+    }
+};
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <limits>
+
+/**
+ * @brief Fast pseudo random generator xoshiro256** (Blackman, Vigna) of 64-bit words. It satisfies
+ * std::uniform_random_bit_generator, state is seeded by splitmix64. Not suitable for cryptography.
+ */
+class MpRandom {
+    // ------------------------------------------------------
+    // ------------------------------------------------------
+    // ------------------ VARIABLES -------------------------
+    // ------------------------------------------------------
+    // ------------------------------------------------------
+private:
+    /** State of generator, never all zero */
+    std::array<std::uint64_t, 4> state{};
+
+    // ------------------------------------------------------
+    // ------------------------------------------------------
+    // ------------------ CONSTRUCTORS ----------------------
+    // ------------------------------------------------------
+    // ------------------------------------------------------
+public:
+    typedef std::uint64_t result_type;
+
+    /**
+     * @param seed Seed of generator, equal seeds give equal sequences.
+     */
+    explicit MpRandom(std::uint64_t seed = 0) {
+        for (auto &word: state) {
+            // splitmix64
+            seed += 0x9e3779b97f4a7c15;
+            auto z = seed;
+            z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9;
+            z = (z ^ (z >> 27)) * 0x94d049bb133111eb;
+            word = z ^ (z >> 31);
+        }
+    }
+
+    // ------------------------------------------------------
+    // ------------------------------------------------------
+    // ------------------ METHODS ---------------------------
+    // ------------------------------------------------------
+    // ------------------------------------------------------
+public:
+    static constexpr result_type min() {
+        return 0;
+    }
+
+    static constexpr result_type max() {
+        return std::numeric_limits<result_type>::max();
+    }
+
+    /**
+     * @return Next random word.
+     */
+    result_type operator()() {
+        auto result = std::rotl(state[1] * 5, 7) * 9;
+        auto shifted = state[1] << 17;
+        state[2] ^= state[0];
+        state[3] ^= state[1];
+        state[1] ^= state[2];
+        state[0] ^= state[3];
+        state[2] ^= shifted;
+        state[3] = std::rotl(state[3], 45);
+        return result;
+    }
+
+    /**
+     * @brief Advance generator by 2^128 words. Generators jumped 1, 2, ... times from one seed give
+     * non-overlapping sequences (e.g. for threads).
+     */
+    void jump() {
+        constexpr std::uint64_t polynomial[] = {0x180ec6d33cfd0aba, 0xd5a61266f0c9392c, 0xa9582618e03fc9aa,
+                                                0x39abdc4529b1661c};
+        std::array<std::uint64_t, 4> jumped{};
+        for (auto word: polynomial) {
+            for (int bit = 0; bit < 64; bit++) {
+                if ((word >> bit & 1) != 0) {
+                    for (std::size_t i = 0; i < jumped.size(); i++) {
+                        jumped[i] ^= state[i];
+                    }
+                }
+                (*this)();
+            }
+        }
+        state = jumped;
+    }
+};
@@ -0,0 +1,481 @@
+#pragma once
+
+#include "MpInt.h"
+#include "MpKernels.h"
+#include "MpProgress.h"
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+/** Minimal count of limb operations of one thread of work across channels */
+constexpr std::size_t RNS_PARALLEL_WORK = 1 << 18;
+/** Count of channels reduced together by conversion from MpInt */
+constexpr std::size_t RNS_INTERLEAVED_CHANNELS = 4;
+/** Bases of Miller-Rabin test, which is deterministic with them for all 64-bit numbers */
+constexpr std::uint64_t RNS_WITNESSES[] = {2, 3, 5, 7, 11, 13, 17, 19, 23, 29, 31, 37};
+
+/**
+ * @brief Number in residue number system: residues modulo channel moduli of shared basis, the largest primes
+ * below 2^64. Addition, subtraction and multiplication work on every channel independently in linear time, so that
+ * long chains of them (determinants, polynomial evaluation) avoid quadratic multiplication of MpInt, channels are
+ * split across threads. Only conversion from MpInt and reconstruction (Chinese remainder theorem over subproduct
+ * tree) are quadratic. Arithmetic is modulo product M of moduli, reconstruction is exact if the final result is in
+ * range of basis, intermediate results may overflow it.
+ */
+class MpRns {
+    // ------------------------------------------------------
+    // ------------------------------------------------------
+    // ------------------ INNER CLASSES ---------------------
+    // ------------------------------------------------------
+    // ------------------------------------------------------
+public:
+    /**
+     * @brief Channel moduli with precomputed data of reconstruction, shared by numbers of one computation.
+     */
+    class Basis {
+    private:
+        /** Count of bits of magnitude of numbers in range */
+        std::size_t bits;
+        /** Channel moduli */
+        std::vector<std::uint64_t> moduli;
+        /** Moduli with precomputed reciprocals */
+        std::vector<MpKernels::Divisor> divisors;
+        /** Inverse of M / m(i) modulo m(i) for every channel i */
+        std::vector<std::uint64_t> coefficients;
+        /** Subproduct tree, level 0 are moduli, every level has products of pairs of level below, last is M */
+        std::vector<std::vector<magnitudeStorage>> tree;
+        /** floor(M / 2), larger residues represent negative numbers */
+        magnitudeStorage half;
+
+        friend class MpRns;
+
+    public:
+        /**
+         * @brief Prepare basis with moduli, whose product exceeds 2^(bits + 1).
+         * @param bits Count of bits of magnitude of numbers in range.
+         */
+        explicit Basis(std::size_t bits) : bits(bits) {
+            MpProgress::Scope progress("baze RNS");
+            // every modulus is above 2^63
+            moduli = findPrimes(std::max<std::size_t>(2, (bits + ELEMENT_BIT_SIZE - 1) / (ELEMENT_BIT_SIZE - 1)));
+            for (auto modulus: moduli) {
+                divisors.emplace_back(modulus);
+            }
+            auto count = moduli.size();
+            tree.emplace_back();
+            for (auto modulus: moduli) {
+                tree.back().push_back(magnitudeStorage{modulus});
+            }
+            while (tree.back().size() > 1) {
+                const auto &below = tree.back();
+                std::vector<magnitudeStorage> level(below.size() / 2);
+                forChannels(level.size(), below[0].size() * below[0].size(), [&below, &level](auto first, auto last) {
+                    for (auto i = first; i < last; i++) {
+                        level[i] = MpInt<MP_INT_UNLIMITED>::multiplyMagnitudes(below[2 * i], below[2 * i + 1]);
+                    }
+                });
+                if (below.size() % 2 != 0) {
+                    level.push_back(below.back());
+                }
+                tree.push_back(std::move(level));
+                progress.report(tree.size(), 2 * (std::bit_width(count) + 1));
+            }
+            half = MpInt<MP_INT_UNLIMITED>::shiftRightMagnitude(tree.back()[0], 1);
+            // cofactor M / P of node with product P modulo P, from root down to moduli
+            std::vector<magnitudeStorage> cofactors{magnitudeStorage{1}};
+            for (auto level = tree.size() - 1; level-- > 0;) {
+                const auto &products = tree[level];
+                std::vector<magnitudeStorage> below(products.size());
+                auto limbs = products[0].size();
+                forChannels(below.size(), 3 * limbs * limbs, [&products, &cofactors, &below](auto first, auto last) {
+                    for (auto i = first; i < last; i++) {
+                        // node without sibling was carried up, its cofactor is the cofactor of parent
+                        if ((i ^ 1) >= products.size()) {
+                            below[i] = cofactors[i / 2];
+                            continue;
+                        }
+                        below[i] = remainder(MpInt<MP_INT_UNLIMITED>::multiplyMagnitudes(
+                                remainder(cofactors[i / 2], products[i]), remainder(products[i ^ 1], products[i])),
+                                             products[i]);
+                    }
+                });
+                cofactors = std::move(below);
+                progress.report(2 * tree.size() - level, 2 * tree.size());
+            }
+            coefficients.resize(count);
+            for (std::size_t i = 0; i < count; i++) {
+                coefficients[i] = power(cofactors[i][0], moduli[i] - 2, divisors[i]);
+            }
+        }
+
+        /**
+         * @return Count of channels.
+         */
+        [[nodiscard]] std::size_t getChannels() const {
+            return moduli.size();
+        }
+
+        /**
+         * @return Count of bits of magnitude of numbers in range.
+         */
+        [[nodiscard]] std::size_t getBits() const {
+            return bits;
+        }
+
+        /**
+         * @return Channel moduli.
+         */
+        [[nodiscard]] const std::vector<std::uint64_t> &getModuli() const {
+            return moduli;
+        }
+    };
+
+    // ------------------------------------------------------
+    // ------------------------------------------------------
+    // ------------------ VARIABLES -------------------------
+    // ------------------------------------------------------
+    // ------------------------------------------------------
+private:
+    /** Basis of channels */
+    std::shared_ptr<const Basis> basis;
+    /** Residue of every channel */
+    std::vector<std::uint64_t> residues;
+
+    // ------------------------------------------------------
+    // ------------------------------------------------------
+    // ------------------ CONSTRUCTORS ----------------------
+    // ------------------------------------------------------
+    // ------------------------------------------------------
+public:
+    /**
+     * @brief Zero in given basis.
+     */
+    explicit MpRns(std::shared_ptr<const Basis> basis) : basis(std::move(basis)) {
+        residues.assign(this->basis->getChannels(), 0);
+    }
+
+    /**
+     * @brief Residues of number in given basis, number out of range is reduced modulo M.
+     */
+    template<std::size_t bytePrecision>
+    MpRns(const MpInt<bytePrecision> &value, std::shared_ptr<const Basis> basis) : MpRns(std::move(basis)) {
+        MpProgress::Scope progress("prevod do RNS");
+        auto magnitude = value.getMagnitude();
+        auto negative = value.isNegative();
+        const auto &moduli = this->basis->moduli;
+        const auto &divisors = this->basis->divisors;
+        forChannels(residues.size(), magnitude.size() + 1, [&](auto first, auto last) {
+            reduce(magnitude, divisors.data() + first, residues.data() + first, last - first);
+            for (auto i = first; i < last && negative; i++) {
+                residues[i] = residues[i] == 0 ? 0 : moduli[i] - residues[i];
+            }
+        });
+    }
+
+    // ------------------------------------------------------
+    // ------------------------------------------------------
+    // ------------------ METHODS ---------------------------
+    // ------------------------------------------------------
+    // ------------------------------------------------------
+public:
+    /**
+     * @brief Prepare shared basis for numbers of magnitude below 2^bits.
+     */
+    static std::shared_ptr<const Basis> makeBasis(std::size_t bits) {
+        return std::make_shared<const Basis>(bits);
+    }
+
+    /**
+     * @brief Reconstruct number by Chinese remainder theorem. Subproduct tree sums
+     * x(i) (M / m(i)) with x(i) = r(i) (M / m(i))^(-1) mod m(i) as products of balanced halves, the sum is reduced
+     * modulo M into range -M / 2 to M / 2. Throw MpIntException if number limitation is overflowed.
+     * @tparam bytePrecision Precision of result.
+     * @return Number with residues of this.
+     */
+    template<std::size_t bytePrecision = MP_INT_UNLIMITED>
+    [[nodiscard]] MpInt<bytePrecision> toInt() const {
+        MpProgress::Scope progress("rekonstrukce z RNS");
+        const auto &tree = basis->tree;
+        std::vector<magnitudeStorage> sums(residues.size());
+        for (std::size_t i = 0; i < residues.size(); i++) {
+            auto leaf = multiplyModulo(residues[i], basis->coefficients[i], basis->divisors[i]);
+            if (leaf != 0) {
+                sums[i].push_back(leaf);
+            }
+        }
+        for (std::size_t level = 0; level + 1 < tree.size(); level++) {
+            const auto &products = tree[level];
+            std::vector<magnitudeStorage> next(sums.size() / 2);
+            auto limbs = products[0].size();
+            forChannels(next.size(), 2 * limbs * limbs, [&sums, &products, &next](auto first, auto last) {
+                for (auto i = first; i < last; i++) {
+                    next[i] = addMagnitudes(
+                            MpInt<MP_INT_UNLIMITED>::multiplyMagnitudes(sums[2 * i], products[2 * i + 1]),
+                            MpInt<MP_INT_UNLIMITED>::multiplyMagnitudes(sums[2 * i + 1], products[2 * i]));
+                }
+            });
+            if (sums.size() % 2 != 0) {
+                next.push_back(std::move(sums.back()));
+            }
+            sums = std::move(next);
+            progress.report(level + 1, tree.size() - 1);
+        }
+        // sum of channels is below count * M
+        auto sum = std::move(sums[0]);
+        const auto &modulus = tree.back()[0];
+        sum = remainder(sum, modulus);
+        bool negative = MpInt<MP_INT_UNLIMITED>::compareMagnitudes(sum, basis->half) > 0;
+        if (negative) {
+            magnitudeStorage difference(modulus.size());
+            sum.resize(modulus.size(), 0);
+            MpKernels::subN(difference.data(), modulus.data(), sum.data(), modulus.size());
+            MpInt<MP_INT_UNLIMITED>::trimMagnitude(difference);
+            sum = std::move(difference);
+        }
+        return MpInt<bytePrecision>::fromMagnitude(std::move(sum), negative);
+    }
+
+    /**
+     * @return Basis of channels.
+     */
+    [[nodiscard]] const std::shared_ptr<const Basis> &getBasis() const {
+        return basis;
+    }
+
+    /**
+     * @return Residue of every channel.
+     */
+    [[nodiscard]] const std::vector<std::uint64_t> &getResidues() const {
+        return residues;
+    }
+
+private:
+    /**
+     * @brief Apply operation to residues of this and other in every channel. Throw std::invalid_argument if
+     * numbers have different bases.
+     * @param operation Callable returning new residue from residues and modulus with reciprocal.
+     */
+    template<class Operation>
+    MpRns &combine(const MpRns &other, const Operation &operation) {
+        if (basis != other.basis) {
+            throw std::invalid_argument("Different bases.");
+        }
+        const auto &divisors = basis->divisors;
+        forChannels(residues.size(), 1, [this, &other, &divisors, &operation](auto first, auto last) {
+            for (auto i = first; i < last; i++) {
+                residues[i] = operation(residues[i], other.residues[i], divisors[i]);
+            }
+        });
+        return *this;
+    }
+
+    /**
+     * @brief Split channels [0, count) into contiguous parts processed in parallel while each part has at least
+     * RNS_PARALLEL_WORK operations, parts beyond the first run on MpProgress::launch.
+     * @param count Count of channels.
+     * @param cost Estimated count of limb operations per channel.
+     * @param work Callable processing channels [first, last).
+     */
+    template<class Work>
+    static void forChannels(std::size_t count, std::size_t cost, const Work &work) {
+        auto parts = std::min<std::size_t>({MpProgress::getThreads(), count, count * cost / RNS_PARALLEL_WORK});
+        if (parts <= 1) {
+            work(std::size_t{0}, count);
+            return;
+        }
+        std::vector<std::future<void>> futures;
+        for (std::size_t part = 1; part < parts; part++) {
+            futures.push_back(MpProgress::launch([&work, count, parts, part] {
+                work(count * part / parts, count * (part + 1) / parts);
+            }));
+        }
+        work(std::size_t{0}, count / parts);
+        for (auto &future: futures) {
+            future.get();
+        }
+    }
+
+    /**
+     * @brief Remainders of magnitude modulo channels, RNS_INTERLEAVED_CHANNELS independent chains of divisions run
+     * at once to hide latency of multiplications.
+     * @param divisors Moduli of first channel.
+     * @param result Residues of first channel.
+     * @param count Count of channels.
+     */
+    static void reduce(const magnitudeStorage &magnitude, const MpKernels::Divisor *divisors, std::uint64_t *result,
+                       std::size_t count) {
+        std::size_t i = 0;
+        for (; i + RNS_INTERLEAVED_CHANNELS <= count; i += RNS_INTERLEAVED_CHANNELS) {
+            MpProgress::checkpoint();
+            std::array<std::uint64_t, RNS_INTERLEAVED_CHANNELS> remainders{};
+            for (auto limb = magnitude.size(); limb-- > 0;) {
+                for (std::size_t j = 0; j < RNS_INTERLEAVED_CHANNELS; j++) {
+                    remainders[j] = divisors[i + j].remainder(remainders[j], magnitude[limb]);
+                }
+            }
+            std::copy(remainders.begin(), remainders.end(), result + i);
+        }
+        for (; i < count; i++) {
+            result[i] = MpKernels::mod1(magnitude.data(), magnitude.size(), divisors[i]);
+        }
+    }
+
+    /**
+     * @return First count primes below 2^64 in descending order, found primes are kept for later bases.
+     */
+    static std::vector<std::uint64_t> findPrimes(std::size_t count) {
+        static std::mutex mutex;
+        static std::vector<std::uint64_t> primes;
+        std::lock_guard lock(mutex);
+        // 2^64 - 1 is divisible by 3
+        for (auto candidate = primes.empty() ? ~std::uint64_t{0} : primes.back(); primes.size() < count;) {
+            candidate -= 2;
+            if (isPrime(candidate)) {
+                primes.push_back(candidate);
+                MpProgress::checkpoint();
+            }
+        }
+        return {primes.begin(), primes.begin() + static_cast<std::ptrdiff_t>(count)};
+    }
+
+    /**
+     * @brief Deterministic Miller-Rabin test of odd number greater than the largest witness.
+     */
+    static bool isPrime(std::uint64_t value) {
+        for (auto witness: RNS_WITNESSES) {
+            if (value % witness == 0) {
+                return false;
+            }
+        }
+        MpKernels::Divisor divisor(value);
+        auto zeros = std::countr_zero(value - 1);
+        auto odd = (value - 1) >> zeros;
+        for (auto witness: RNS_WITNESSES) {
+            auto x = power(witness, odd, divisor);
+            if (x == 1) {
+                continue;
+            }
+            for (int i = 1; i < zeros && x != value - 1; i++) {
+                x = multiplyModulo(x, x, divisor);
+            }
+            if (x != value - 1) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /**
+     * @return a * b mod modulus, a and b must be less than modulus.
+     */
+    static std::uint64_t multiplyModulo(std::uint64_t a, std::uint64_t b, const MpKernels::Divisor &modulus) {
+        auto product = static_cast<unsigned __int128>(a) * b;
+        return modulus.remainder(static_cast<std::uint64_t>(product >> 64), static_cast<std::uint64_t>(product));
+    }
+
+    /**
+     * @return base^exponent mod modulus, base must be less than modulus.
+     */
+    static std::uint64_t power(std::uint64_t base, std::uint64_t exponent, const MpKernels::Divisor &modulus) {
+        std::uint64_t result = 1;
+        for (; exponent != 0; exponent >>= 1) {
+            if ((exponent & 1) != 0) {
+                result = multiplyModulo(result, base, modulus);
+            }
+            base = multiplyModulo(base, base, modulus);
+        }
+        return result;
+    }
+
+    /**
+     * @return Sum of magnitudes without leading zero words.
+     */
+    static magnitudeStorage addMagnitudes(magnitudeStorage a, const magnitudeStorage &b) {
+        if (a.size() < b.size()) {
+            a.resize(b.size(), 0);
+        }
+        a.push_back(0);
+        if (!b.empty()) {
+            auto carry = MpKernels::addN(a.data(), a.data(), b.data(), b.size());
+            MpKernels::add1(a.data() + b.size(), a.data() + b.size(), a.size() - b.size(), carry);
+        }
+        MpInt<MP_INT_UNLIMITED>::trimMagnitude(a);
+        return a;
+    }
+
+    /**
+     * @return Remainder of a / modulus without leading zero words, modulus must not be empty.
+     */
+    static magnitudeStorage remainder(const magnitudeStorage &a, const magnitudeStorage &modulus) {
+        if (MpInt<MP_INT_UNLIMITED>::compareMagnitudes(a, modulus) < 0) {
+            return a;
+        }
+        magnitudeStorage result(modulus.size());
+        if (modulus.size() == 1) {
+            result[0] = MpKernels::mod1(a.data(), a.size(), modulus[0]);
+        } else {
+            magnitudeStorage quotient(a.size() - modulus.size() + 1);
+            MpKernels::divRem(quotient.data(), result.data(), a.data(), a.size(), modulus.data(), modulus.size());
+        }
+        MpInt<MP_INT_UNLIMITED>::trimMagnitude(result);
+        return result;
+    }
+
+    // ------------------------------------------------------
+    // ------------------------------------------------------
+    // ------------------ OPERATORS -------------------------
+    // ------------------------------------------------------
+    // ------------------------------------------------------
+public:
+    MpRns &operator+=(const MpRns &other) {
+        return combine(other, [](std::uint64_t a, std::uint64_t b, const MpKernels::Divisor &modulus) {
+            auto m = modulus.get();
+            auto sum = a + b;
+            return sum < a || sum >= m ? sum - m : sum;
+        });
+    }
+
+    MpRns &operator-=(const MpRns &other) {
+        return combine(other, [](std::uint64_t a, std::uint64_t b, const MpKernels::Divisor &modulus) {
+            return a >= b ? a - b : a - b + modulus.get();
+        });
+    }
+
+    MpRns &operator*=(const MpRns &other) {
+        return combine(other, [](std::uint64_t a, std::uint64_t b, const MpKernels::Divisor &modulus) {
+            return multiplyModulo(a, b, modulus);
+        });
+    }
+
+    friend MpRns operator+(MpRns a, const MpRns &b) {
+        return a += b;
+    }
+
+    friend MpRns operator-(MpRns a, const MpRns &b) {
+        return a -= b;
+    }
+
+    friend MpRns operator*(MpRns a, const MpRns &b) {
+        return a *= b;
+    }
+
+    friend MpRns operator-(MpRns a) {
+        const auto &moduli = a.basis->getModuli();
+        for (std::size_t i = 0; i < a.residues.size(); i++) {
+            a.residues[i] = a.residues[i] == 0 ? 0 : moduli[i] - a.residues[i];
+        }
+        return a;
+    }
+
+    /**
+     * @return True if numbers have the same basis and are congruent modulo M.
+     */
+    friend bool operator==(const MpRns &a, const MpRns &b) {
+        return a.basis == b.basis && a.residues == b.residues;
+    }
+};
@@ -0,0 +1,104 @@
+#pragma once
+
+#include "MpInt.h"
+#include "MpProgress.h"
+#include <algorithm>
+#include <future>
+#include <utility>
+
+/** Smallest count of terms of subtree whose halves are summed in parallel */
+constexpr std::uint64_t SERIES_PARALLEL_TERMS = 512;
+
+/**
+ * @brief Term n of series for MpSeries: coefficient a(n) and ratio p(n) / q(n) of consecutive products.
+ */
+struct MpSeriesTerm {
+    /** Coefficient a(n) */
+    MpInt<MP_INT_UNLIMITED> a;
+    /** Numerator p(n) of ratio */
+    MpInt<MP_INT_UNLIMITED> p;
+    /** Positive denominator q(n) of ratio */
+    MpInt<MP_INT_UNLIMITED> q;
+};
+
+/**
+ * @brief Binary splitting of series S = sum of a(n) p(0) ... p(n) / (q(0) ... q(n)) over n = 0, ..., count - 1
+ * with integer a, p and q (e.g. hypergeometric series of e, pi or ln 2). Sum is one fraction T / Q of products of
+ * balanced halves, so that the work is in few large multiplications. Halves of large subtrees run in parallel
+ * (MpProgress::launch) while there are threads left.
+ */
+class MpSeries {
+    // ------------------------------------------------------
+    // ------------------------------------------------------
+    // ------------------ INNER CLASSES ---------------------
+    // ------------------------------------------------------
+    // ------------------------------------------------------
+private:
+    /**
+     * @brief Inner structure for sum of subtree [first, last): P = p(first) ... p(last - 1), Q likewise and
+     * T / Q = sum of a(n) p(first) ... p(n) / (q(first) ... q(n)).
+     */
+    struct Split {
+        /** Product of p, empty if it is not needed */
+        MpInt<MP_INT_UNLIMITED> p;
+        /** Product of q */
+        MpInt<MP_INT_UNLIMITED> q;
+        /** Numerator of sum */
+        MpInt<MP_INT_UNLIMITED> t;
+    };
+
+    // ------------------------------------------------------
+    // ------------------------------------------------------
+    // ------------------ METHODS ---------------------------
+    // ------------------------------------------------------
+    // ------------------------------------------------------
+public:
+    /**
+     * @brief Sum series by binary splitting.
+     * @param term Callable returning MpSeriesTerm of index n, it may be called from several threads at once.
+     * @param count Count of summed terms (at least 1).
+     * @return Numerator T and denominator Q of sum S = T / Q.
+     */
+    template<class Term>
+    static std::pair<MpInt<MP_INT_UNLIMITED>, MpInt<MP_INT_UNLIMITED>> sum(const Term &term, std::uint64_t count) {
+        MpProgress::Scope progress("soucet rady");
+        auto split = splitSeries(term, 0, std::max<std::uint64_t>(count, 1), 1, false);
+        return {std::move(split.t), std::move(split.q)};
+    }
+
+private:
+    /**
+     * @brief Sum subtree [first, last). With halves L and R it is P = P_L P_R, Q = Q_L Q_R and
+     * T = T_L Q_R + P_L T_R. P of the rightmost subtrees is never used, so it is not computed.
+     * @param width Count of subtrees computed in parallel at this level.
+     * @param needP True if P of subtree is computed.
+     */
+    template<class Term>
+    static Split splitSeries(const Term &term, std::uint64_t first, std::uint64_t last, unsigned width,
+                             bool needP) {
+        if (last - first == 1) {
+            MpSeriesTerm leaf = term(first);
+            auto t = leaf.a * leaf.p;
+            return {needP ? std::move(leaf.p) : MpInt<MP_INT_UNLIMITED>(), std::move(leaf.q), std::move(t)};
+        }
+        auto middle = first + (last - first) / 2;
+        Split left, right;
+        if (width * 2 <= MpProgress::getThreads() && last - first >= SERIES_PARALLEL_TERMS) {
+            auto future = MpProgress::launch([&term, first, middle, width] {
+                return splitSeries(term, first, middle, width * 2, true);
+            });
+            right = splitSeries(term, middle, last, width * 2, needP);
+            left = future.get();
+        } else {
+            left = splitSeries(term, first, middle, width, true);
+            right = splitSeries(term, middle, last, width, needP);
+        }
+        Split result;
+        result.t = left.t * right.q + left.p * right.t;
+        result.q = left.q * right.q;
+        if (needP) {
+            result.p = left.p * right.p;
+        }
+        return result;
+    }
+};
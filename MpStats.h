@@ -0,0 +1,268 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <ostream>
+
+#ifdef MP_INT_STATS
+/** True if instrumentation is compiled in (define MP_INT_STATS) */
+constexpr bool MP_STATS_ENABLED = true;
+#else
+/** True if instrumentation is compiled in (define MP_INT_STATS) */
+constexpr bool MP_STATS_ENABLED = false;
+#endif
+
+/**
+ * @brief Count of logarithmic histogram buckets, bucket i holds values with bit width i.
+ */
+constexpr std::size_t STATS_BUCKETS = 65;
+
+/**
+ * @brief Instrumented operation. Sizes of arithmetic operations are operand bits, sizes of conversions characters,
+ * expressions (evaluation of one terminal input) have size 0.
+ */
+enum class MpStatsOperation {
+    ADD,
+    SUBTRACT,
+    MULTIPLY,
+    DIVIDE,
+    FACTORIAL,
+    PARSE,
+    FORMAT,
+    EXPRESSION,
+    COUNT
+};
+
+/**
+ * @brief Global operation counters and histograms of MpInt and MpTerm. All recording compiles to nothing unless
+ * MP_INT_STATS is defined. Counts include operations called internally (e.g. additions of multiplication).
+ */
+class MpStats {
+private:
+    /**
+     * @brief Inner structure with counters of one operation (atomics are value-initialized to zero).
+     */
+    struct Counters {
+        /** Count of calls */
+        std::atomic<std::uint64_t> count;
+        /** Sum of durations in nanoseconds */
+        std::atomic<std::uint64_t> nanoseconds;
+        /** Sum of sizes */
+        std::atomic<std::uint64_t> size;
+        /** Histogram of sizes by bit width */
+        std::array<std::atomic<std::uint64_t>, STATS_BUCKETS> sizeHistogram;
+        /** Histogram of durations in nanoseconds by bit width */
+        std::array<std::atomic<std::uint64_t>, STATS_BUCKETS> timeHistogram;
+    };
+
+    // ------------------------------------------------------
+    // ------------------------------------------------------
+    // ------------------ VARIABLES -------------------------
+    // ------------------------------------------------------
+    // ------------------------------------------------------
+private:
+    /** Counters indexed by operation */
+    static inline std::array<Counters, static_cast<std::size_t>(MpStatsOperation::COUNT)> operations;
+    /** Count of heap allocations of limbs */
+    static inline std::atomic<std::uint64_t> heapAllocations = 0;
+    /** Bytes of heap allocations of limbs */
+    static inline std::atomic<std::uint64_t> heapBytes = 0;
+    /** Count of memory-mapped allocations of limbs */
+    static inline std::atomic<std::uint64_t> mappedAllocations = 0;
+    /** Bytes of memory-mapped allocations of limbs */
+    static inline std::atomic<std::uint64_t> mappedBytes = 0;
+
+    /** Names of operations */
+    static constexpr std::array<const char *, static_cast<std::size_t>(MpStatsOperation::COUNT)> NAMES = {
+            "add", "subtract", "multiply", "divide", "factorial", "parse", "format", "expression"};
+
+    // ------------------------------------------------------
+    // ------------------------------------------------------
+    // ------------------ INNER CLASSES ---------------------
+    // ------------------------------------------------------
+    // ------------------------------------------------------
+public:
+    /**
+     * @brief RAII measurement of one operation, recorded when it goes out of scope (also by exception).
+     */
+    class Timer {
+#ifdef MP_INT_STATS
+    private:
+        /** Measured operation */
+        MpStatsOperation operation;
+        /** Size of operation */
+        std::size_t size;
+        /** Start of measurement */
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    public:
+        Timer(MpStatsOperation operation, std::size_t size) : operation(operation), size(size) {
+        }
+
+        ~Timer() {
+            auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::steady_clock::now() - start);
+            record(operation, size, static_cast<std::uint64_t>(elapsed.count()));
+        }
+
+        /**
+         * @brief Set size known only at the end of operation.
+         */
+        void setSize(std::size_t value) {
+            size = value;
+        }
+#else
+    public:
+        Timer(MpStatsOperation, std::size_t) {
+        }
+
+        void setSize(std::size_t) {
+        }
+#endif
+
+        Timer(const Timer &) = delete;
+
+        Timer &operator=(const Timer &) = delete;
+    };
+
+    // ------------------------------------------------------
+    // ------------------------------------------------------
+    // ------------------ METHODS ---------------------------
+    // ------------------------------------------------------
+    // ------------------------------------------------------
+public:
+    /**
+     * @brief Record one operation.
+     * @param operation Operation.
+     * @param size Operand bits or converted characters.
+     * @param nanoseconds Duration.
+     */
+    static void record(MpStatsOperation operation, std::size_t size, std::uint64_t nanoseconds) {
+        if constexpr (MP_STATS_ENABLED) {
+            auto &counters = operations[static_cast<std::size_t>(operation)];
+            counters.count.fetch_add(1, std::memory_order_relaxed);
+            counters.nanoseconds.fetch_add(nanoseconds, std::memory_order_relaxed);
+            counters.size.fetch_add(size, std::memory_order_relaxed);
+            counters.sizeHistogram[std::bit_width(size)].fetch_add(1, std::memory_order_relaxed);
+            counters.timeHistogram[std::bit_width(nanoseconds)].fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    /**
+     * @brief Record allocation of limb storage.
+     * @param bytes Size of block.
+     * @param mapped True if block is memory-mapped.
+     */
+    static void recordAllocation(std::size_t bytes, bool mapped) {
+        if constexpr (MP_STATS_ENABLED) {
+            (mapped ? mappedAllocations : heapAllocations).fetch_add(1, std::memory_order_relaxed);
+            (mapped ? mappedBytes : heapBytes).fetch_add(bytes, std::memory_order_relaxed);
+        }
+    }
+
+    /**
+     * @brief Reset all counters.
+     */
+    static void reset() {
+        for (auto &counters: operations) {
+            counters.count = 0;
+            counters.nanoseconds = 0;
+            counters.size = 0;
+            for (auto &bucket: counters.sizeHistogram) {
+                bucket = 0;
+            }
+            for (auto &bucket: counters.timeHistogram) {
+                bucket = 0;
+            }
+        }
+        heapAllocations = 0;
+        heapBytes = 0;
+        mappedAllocations = 0;
+        mappedBytes = 0;
+    }
+
+    /**
+     * @brief Print counters in human readable form.
+     * @param stream Output stream.
+     */
+    static void print(std::ostream &stream) {
+        if constexpr (!MP_STATS_ENABLED) {
+            stream << "Statistiky nejsou zapnuty (prelozte s MP_INT_STATS)." << std::endl;
+            return;
+        }
+        for (std::size_t i = 0; i < operations.size(); i++) {
+            auto count = operations[i].count.load();
+            if (count == 0) {
+                continue;
+            }
+            auto nanoseconds = operations[i].nanoseconds.load();
+            stream << NAMES[i] << ": " << count << "x, celkem " << nanoseconds / 1000 << " us, prumerne "
+                   << nanoseconds / count << " ns, prumerna velikost " << operations[i].size.load() / count
+                   << std::endl;
+        }
+        stream << "Alokace: " << heapAllocations.load() << "x halda (" << heapBytes.load() << " B), "
+               << mappedAllocations.load() << "x mapovane (" << mappedBytes.load() << " B)" << std::endl;
+    }
+
+    /**
+     * @brief Write counters and histograms as JSON. Histograms are arrays of [bit width, count] pairs of nonempty
+     * buckets, i.e. bucket w counts values in [2^(w-1), 2^w).
+     * @param stream Output stream.
+     */
+    static void writeJson(std::ostream &stream) {
+        stream << "{\"enabled\":" << (MP_STATS_ENABLED ? "true" : "false") << ",\"operations\":{";
+        for (std::size_t i = 0; i < operations.size(); i++) {
+            const auto &counters = operations[i];
+            stream << (i == 0 ? "" : ",") << '"' << NAMES[i] << "\":{\"count\":" << counters.count.load()
+                   << ",\"nanoseconds\":" << counters.nanoseconds.load() << ",\"size\":" << counters.size.load()
+                   << ",\"size_histogram\":";
+            writeHistogram(stream, counters.sizeHistogram);
+            stream << ",\"time_histogram\":";
+            writeHistogram(stream, counters.timeHistogram);
+            stream << '}';
+        }
+        stream << "},\"allocations\":{\"heap\":{\"count\":" << heapAllocations.load() << ",\"bytes\":"
+               << heapBytes.load() << "},\"mapped\":{\"count\":" << mappedAllocations.load() << ",\"bytes\":"
+               << mappedBytes.load() << "}}}" << std::endl;
+    }
+
+    /**
+     * @brief Write JSON of counters at program exit to file MPINT_STATS_FILE (standard error if it is not set).
+     * Does nothing unless instrumentation is compiled in.
+     */
+    static void dumpAtExit() {
+        if constexpr (MP_STATS_ENABLED) {
+            std::atexit([] {
+                if (auto path = std::getenv("MPINT_STATS_FILE")) {
+                    std::ofstream file(path);
+                    writeJson(file);
+                } else {
+                    writeJson(std::cerr);
+                }
+            });
+        }
+    }
+
+private:
+    /**
+     * @brief Write nonempty buckets of histogram as JSON array.
+     */
+    static void writeHistogram(std::ostream &stream,
+                               const std::array<std::atomic<std::uint64_t>, STATS_BUCKETS> &histogram) {
+        stream << '[';
+        bool first = true;
+        for (std::size_t width = 0; width < histogram.size(); width++) {
+            if (auto count = histogram[width].load()) {
+                stream << (first ? "" : ",") << '[' << width << ',' << count << ']';
+                first = false;
+            }
+        }
+        stream << ']';
+    }
+};
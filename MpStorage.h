@@ -0,0 +1,211 @@
+#pragma once
+
+#include <atomic>
+#include <charconv>
+#include <cstddef>
+#include <cstdlib>
+#include <limits>
+#include <mutex>
+#include <new>
+#include <string>
+#include <string_view>
+#include "MpStats.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+#define MP_STORAGE_MAPPING_SUPPORTED
+#endif
+
+/** Threshold value disabling memory-mapped storage */
+constexpr std::size_t MP_STORAGE_NEVER_MAP = std::numeric_limits<std::size_t>::max();
+
+/**
+ * @brief Global configuration of storage backend used by MpInt limbs.
+ * Blocks smaller than mapped threshold live on heap, larger blocks are kept in memory-mapped temporary files, so
+ * the operating system can page them out instead of failing with std::bad_alloc.
+ */
+class MpStorage {
+    // ------------------------------------------------------
+    // ------------------------------------------------------
+    // ------------------ VARIABLES -------------------------
+    // ------------------------------------------------------
+    // ------------------------------------------------------
+private:
+    /** Size in bytes from which blocks are memory-mapped */
+    static inline std::atomic<std::size_t> mappedThreshold = MP_STORAGE_NEVER_MAP;
+    /** Directory where temporary files are created */
+    static inline std::string mappedDirectory = "/tmp";
+    /** Guard of mapped directory */
+    static inline std::mutex directoryMutex;
+
+    // ------------------------------------------------------
+    // ------------------------------------------------------
+    // ------------------ METHODS ---------------------------
+    // ------------------------------------------------------
+    // ------------------------------------------------------
+public:
+    /**
+     * @brief Set size of block from which memory-mapped storage is used.
+     * @param bytes Threshold in bytes. MP_STORAGE_NEVER_MAP disables mapping.
+     */
+    static void setMappedThreshold(std::size_t bytes) {
+        mappedThreshold = bytes;
+    }
+
+    /**
+     * @return Size of block from which memory-mapped storage is used.
+     */
+    static std::size_t getMappedThreshold() {
+        return mappedThreshold;
+    }
+
+    /**
+     * @brief Set directory for temporary files of memory-mapped storage.
+     * @param directory Path to directory. It should be on a disk with enough free space.
+     */
+    static void setMappedDirectory(const std::string &directory) {
+        std::lock_guard lock(directoryMutex);
+        mappedDirectory = directory;
+    }
+
+    /**
+     * @return Directory for temporary files of memory-mapped storage.
+     */
+    static std::string getMappedDirectory() {
+        std::lock_guard lock(directoryMutex);
+        return mappedDirectory;
+    }
+
+    /**
+     * @brief Configure storage from environment variables MPINT_MAP_THRESHOLD (bytes) and MPINT_MAP_DIR.
+     * @return False if MPINT_MAP_THRESHOLD is not a number, the threshold is kept then.
+     */
+    static bool configureFromEnvironment() {
+        bool valid = true;
+        if (auto threshold = std::getenv("MPINT_MAP_THRESHOLD")) {
+            std::string_view text(threshold);
+            std::size_t bytes = 0;
+            auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), bytes);
+            valid = error == std::errc() && end == text.data() + text.size() && !text.empty();
+            if (valid) {
+                setMappedThreshold(bytes);
+            }
+        }
+        if (auto directory = std::getenv("MPINT_MAP_DIR")) {
+            setMappedDirectory(directory);
+        }
+        return valid;
+    }
+
+    /**
+     * @brief Allocate raw block. Block is memory-mapped if it is at least threshold bytes large.
+     * @param bytes Size of block in bytes.
+     * @return Pointer to block aligned to std::max_align_t.
+     */
+    static void *allocate(std::size_t bytes) {
+        const std::size_t total = bytes + HEADER_SIZE;
+        std::size_t *header = nullptr;
+#ifdef MP_STORAGE_MAPPING_SUPPORTED
+        if (bytes >= getMappedThreshold()) {
+            header = static_cast<std::size_t *>(mapTemporaryFile(total));
+            *header = total;
+        }
+#endif
+        if (header == nullptr) {
+            header = static_cast<std::size_t *>(::operator new(total));
+            *header = 0;
+        }
+        MpStats::recordAllocation(bytes, *header != 0);
+        return reinterpret_cast<char *>(header) + HEADER_SIZE;
+    }
+
+    /**
+     * @brief Release block allocated by allocate().
+     * @param pointer Pointer to block.
+     */
+    static void deallocate(void *pointer) noexcept {
+        auto header = reinterpret_cast<std::size_t *>(static_cast<char *>(pointer) - HEADER_SIZE);
+#ifdef MP_STORAGE_MAPPING_SUPPORTED
+        if (*header != 0) {
+            munmap(header, *header);
+            return;
+        }
+#endif
+        ::operator delete(header);
+    }
+
+private:
+    /** Size of hidden header storing mapped length (0 for heap blocks) */
+    static constexpr std::size_t HEADER_SIZE = alignof(std::max_align_t);
+
+#ifdef MP_STORAGE_MAPPING_SUPPORTED
+
+    /**
+     * @brief Create unlinked temporary file of given length and map it to memory.
+     * @param length Length of mapping in bytes.
+     * @return Pointer to mapping.
+     */
+    static void *mapTemporaryFile(std::size_t length) {
+        auto path = getMappedDirectory() + "/mpint-XXXXXX";
+        int fd = mkstemp(path.data());
+        if (fd == -1) {
+            throw std::bad_alloc();
+        }
+        unlink(path.c_str());
+        if (ftruncate(fd, static_cast<off_t>(length)) != 0) {
+            close(fd);
+            throw std::bad_alloc();
+        }
+        void *mapping = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        close(fd);
+        if (mapping == MAP_FAILED) {
+            throw std::bad_alloc();
+        }
+        madvise(mapping, length, MADV_SEQUENTIAL);
+        return mapping;
+    }
+
+#endif
+};
+
+/**
+ * @brief Allocator for limbs of MpInt backed by MpStorage.
+ * @tparam type Allocated type.
+ */
+template<class type>
+class MpAllocator {
+public:
+    using value_type = type;
+
+    MpAllocator() noexcept = default;
+
+    /** Rebind constructor */
+    template<class otherType>
+    MpAllocator(const MpAllocator<otherType> &) noexcept {}
+
+    /**
+     * @param count Number of items.
+     * @return Pointer to uninitialized storage for count items.
+     */
+    type *allocate(std::size_t count) {
+        if (count > std::numeric_limits<std::size_t>::max() / sizeof(type)) {
+            throw std::bad_array_new_length();
+        }
+        return static_cast<type *>(MpStorage::allocate(count * sizeof(type)));
+    }
+
+    /**
+     * @param pointer Storage returned by allocate().
+     */
+    void deallocate(type *pointer, std::size_t) noexcept {
+        MpStorage::deallocate(pointer);
+    }
+
+    template<class otherType>
+    bool operator==(const MpAllocator<otherType> &) const noexcept {
+        return true;
+    }
+};
@@ -1,36 +1,47 @@
 #pragma once
 
 #include "MpInt.h"
-#include <regex>
+#include "MpExpression.h"
+#include "MpCache.h"
+#include "MpCombinatorics.h"
 #include <array>
+#include <chrono>
+#include <csignal>
+#include <future>
 #include <map>
 #include <optional>
 #include <functional>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <thread>
 
 /**
- * @brief Size of terminal bank - last used memory
+ * @brief Default size of terminal bank - last used memory
  */
-constexpr int BANK_SIZE = 5;
+constexpr std::size_t BANK_SIZE = 5;
 /**
- * @brief Regex for terminal addition input
+ * @brief Maximal size of terminal bank set by command "bank <size>".
  */
-const std::regex ADDITION_REG(R"(^\s*(-?\d+|\$[0-5]{1})\s*\+\s*(-?\d+|\$[0-5]{1})\s*$)");
+constexpr std::size_t MAX_BANK_SIZE = 100'000;
 /**
- * @brief Regex for terminal subtraction input
+ * @brief Count of batch lines kept in flight per worker thread.
  */
-const std::regex SUBTRACT_REG(R"(^\s*(-?\d+|\$[0-5]{1})\s*\-\s*(-?\d+|\$[0-5]{1})\s*$)");
+constexpr std::size_t BATCH_WINDOW_PER_THREAD = 64;
 /**
- * @brief Regex for terminal multiply input
+ * @brief Minimal total capacity of operands in bits from which multiplication and division results are cached.
  */
-const std::regex MULTIPLY_REG(R"(^\s*(-?\d+|\$[0-5]{1})\s*\*\s*(-?\d+|\$[0-5]{1})\s*$)");
+constexpr std::size_t CACHE_MIN_BITS = 512;
 /**
- * @brief Regex for terminal division input
+ * @brief Interval of progress reports of interactive computation.
  */
-const std::regex DIVIDE_REG(R"(^\s*(-?\d+|\$[0-5]{1})\s*\/\s*(-?\d+|\$[0-5]{1})\s*$)");
+constexpr std::chrono::milliseconds PROGRESS_INTERVAL{200};
 /**
- * @brief Regex for terminal factorial input
+ * @brief Width of progress line, used to erase it.
  */
-const std::regex FACTORIAL_REG(R"(^\s*(-?\d+|\$[0-5]{1})!\s*$)");
+constexpr std::size_t PROGRESS_WIDTH = 79;
 
 /**
  * @brief Class representing terminal for unlimited number operations.
@@ -38,52 +49,110 @@ const std::regex FACTORIAL_REG(R"(^\s*(-?\d+|\$[0-5]{1})!\s*$)");
  */
 template<std::size_t bytePrecision> requires SizeLimitation<bytePrecision>
 class MpTerm {
-private :
+public:
     /**
-     * @brief Inner class for rotating list - used for bank.
+     * @brief Inner class for fixed size ring buffer of values - used for bank. Index 0 is the newest item.
      */
-    class RotatingVector {
+    class RingBuffer {
     private:
-        /** Maximal size of rotating list */
-        const std::size_t rotatingSize;
-        /** Items of rotating list */
-        std::vector<MpInt<bytePrecision> *> results; // Not the best use of RAII, but I couldn't think of anything better. 
+        /** Storage of items */
+        std::vector<MpInt<bytePrecision>> items;
+        /** Position of newest item in storage */
+        std::size_t newest = 0;
+        /** Count of stored items */
+        std::size_t count = 0;
     public:
         /**
-         * @brief Set maximal size of rotating list.
-         * @param size Maximal size of rotating list.
+         * @brief Set maximal size of ring buffer.
+         * @param size Maximal size of ring buffer.
          */
-        explicit RotatingVector(std::size_t size) : rotatingSize(size) {
+        explicit RingBuffer(std::size_t size) : items(size) {
 
         }
 
-        ~RotatingVector() {
-            for (auto item : this->results) {
-                delete(item);
+        /**
+         * @brief Push item to begin of ring buffer. If buffer is full, the oldest item is overwritten.
+         * @param item Item to be pushed.
+         */
+        void push(MpInt<bytePrecision> &&item) {
+            if (this->items.empty()) {
+                return;
             }
+            this->newest = (this->newest + this->items.size() - 1) % this->items.size();
+            this->items[this->newest] = std::move(item);
+            this->count = std::min(this->count + 1, this->items.size());
         }
 
         /**
-         * @brief Push item to begin of rotating list. If list is full, pop last item.
-         * @param item Item to be pushed.
+         * @param index Index of item, 0 is the newest one.
+         * @return Item on index.
          */
-        void push(const MpInt<bytePrecision> &item) {
-            if (this->results.size() == this->rotatingSize) {
-                auto value = this->results[this->results.size() - 1];
-                this->results.pop_back();
-                delete(value);
-            }
-            this->results.insert(this->results.begin(), new MpInt<bytePrecision>(item));
+        const MpInt<bytePrecision> &operator[](std::size_t index) const {
+            return this->items[(this->newest + index) % this->items.size()];
         }
 
         /**
-         * @return All items of rotating list.
+         * @return Count of stored items.
          */
-        std::vector<MpInt<bytePrecision> *> getResults() const {
-            return results;
+        [[nodiscard]] std::size_t size() const {
+            return this->count;
         }
 
+        /**
+         * @return True if there is no item.
+         */
+        [[nodiscard]] bool empty() const {
+            return this->count == 0;
+        }
 
+        /**
+         * @brief Change maximal size of ring buffer, keeping the newest items.
+         * @param size New maximal size.
+         */
+        void resize(std::size_t size) {
+            std::vector<MpInt<bytePrecision>> resized(size);
+            auto kept = std::min(this->count, size);
+            for (std::size_t i = 0; i < kept; i++) {
+                resized[i] = std::move(this->items[(this->newest + i) % this->items.size()]);
+            }
+            this->items = std::move(resized);
+            this->newest = 0;
+            this->count = kept;
+        }
+    };
+
+private:
+    /**
+     * @brief Inner structure for one line of parallel batch input.
+     */
+    struct BatchTask {
+        /** Number of line in input */
+        std::size_t lineNumber;
+        /** Parsed expression or "nullopt" on syntax error */
+        std::optional<MpExpression> expression;
+        /** Result pushed to bank once the line is written */
+        std::optional<MpInt<bytePrecision>> result;
+        /** Formatted output line */
+        std::string output;
+        /** True if output is ready */
+        bool done = false;
+
+        /**
+         * @return True if task has to be evaluated in input order (it reads bank).
+         */
+        [[nodiscard]] bool isOrdered() const {
+            return !expression.has_value() || expression->hasBankReference();
+        }
+    };
+
+    /**
+     * @brief Inner structure for function callable from expressions.
+     */
+    struct Function {
+        /** Count of arguments */
+        std::size_t arity;
+        /** Computation of result from arguments */
+        std::function<MpInt<bytePrecision>(const std::vector<MpInt<bytePrecision>> &)> apply;
     };
 
     // ------------------------------------------------------
@@ -95,7 +164,7 @@ private:
     /**
      * @brief Bank used for memorizing last N computed number.
      */
-    RotatingVector bank;
+    RingBuffer bank;
 
     /**
      * @brief Map for binary operations according to operator.
@@ -103,9 +172,29 @@ private:
     std::map<char, std::function<MpInt<bytePrecision>(const MpInt<bytePrecision> &,
                                                       const MpInt<bytePrecision> &)>> binaryOperatorMap;
     /**
-     * @brief Map for unary operations according to operator.
+     * @brief Map for unary operations according to operator ('-' negation, '!' factorial).
      */
     std::map<char, std::function<MpInt<bytePrecision>(const MpInt<bytePrecision> &)>> unaryOperatorMap;
+    /**
+     * @brief Map for functions according to name.
+     */
+    std::map<std::string, Function, std::less<>> functionMap;
+    /**
+     * @brief Cache of expensive operation results (factorial, multiplication and division of large numbers).
+     */
+    MpResultCache<bytePrecision> resultCache;
+    /**
+     * @brief Cache of the largest computed factorial, its size is charged to budget of result cache.
+     */
+    MpFactorialCache factorialCache;
+    /**
+     * @brief Time limit of one computation, zero for none.
+     */
+    std::chrono::seconds timeout{0};
+    /**
+     * @brief Set by SIGINT handler while interactive computation runs.
+     */
+    static inline std::atomic<bool> interruptRequested = false;
 
     // ------------------------------------------------------
     // ------------------------------------------------------
@@ -113,7 +202,12 @@ private:
     // ------------------------------------------------------
     // ------------------------------------------------------
 public:
-    MpTerm() : bank(BANK_SIZE), binaryOperatorMap({
+    /**
+     * @param bankSize Count of remembered results.
+     * @param cacheBudget Memory budget of result cache in bytes.
+     */
+    explicit MpTerm(std::size_t bankSize = BANK_SIZE, std::size_t cacheBudget = CACHE_BUDGET)
+            : bank(bankSize), binaryOperatorMap({
                                                           {'+', [](const MpInt<bytePrecision> &a,
                                                                    const MpInt<bytePrecision> &b) { return a + b; }},
                                                           {'-', [](const MpInt<bytePrecision> &a,
@@ -124,9 +218,26 @@ public:
                                                                    const MpInt<bytePrecision> &b) { return a / b; }}
 
                                                   }),
-               unaryOperatorMap({{
-                                         '!', [](const MpInt<bytePrecision> &a) { return a.factorial(); }
-                                 }}) {
+               unaryOperatorMap({
+                                        {'!', [this](const MpInt<bytePrecision> &a) {
+                                            return factorialCache.get(a);
+                                        }},
+                                        {'-', [](const MpInt<bytePrecision> &a) {
+                                            return MpInt<bytePrecision>(0LL) - a;
+                                        }}
+                                }),
+               functionMap({
+                                   {"fib", {1, [](const std::vector<MpInt<bytePrecision>> &arguments) {
+                                       return MpCombinatorics::fib(arguments[0]);
+                                   }}},
+                                   {"binomial", {2, [](const std::vector<MpInt<bytePrecision>> &arguments) {
+                                       return MpCombinatorics::binomial(arguments[0], arguments[1]);
+                                   }}},
+                                   {"multifactorial", {2, [](const std::vector<MpInt<bytePrecision>> &arguments) {
+                                       return MpCombinatorics::multifactorial(arguments[0], arguments[1]);
+                                   }}}
+                           }),
+               resultCache(cacheBudget), factorialCache(cacheBudget) {
 
     };
     // ------------------------------------------------------
@@ -167,50 +278,130 @@ private:
     }
 
     /**
-     * @brief Split terminal string according to delimiter. String must be checked with proper regex to call this method on it.
-     * @param s Terminal input.
-     * @param delim Operator delimiter.
-     * @return Array of two string terms.
-     */
-    std::array<std::string, 2> split(const std::string &s, char delim) {
-        std::array<std::string, 2> result;
-        auto ignoreSubChar = delim == '-';
-        auto trimmed = trim(s);
-        auto termStart = true;
-        int termIndex = 0;
-
-        for (auto i = 0; i < s.length(); i++) {
-            if (s[i] == delim) {
-                if (ignoreSubChar && termStart) {
-                    result[termIndex] = '-';
-                    continue;
-                } else {
-                    termIndex++;
-                    termStart = true;
-                    continue;
-                }
-            }
-            result[termIndex] += s[i];
-            termStart = false;
+     * @brief Find item of bank or return "nullopt" if index is above bank size.
+     * @param index One-based index of bank item.
+     * @return Optional Term.
+     */
+    std::optional<MpInt<bytePrecision>> getBankItem(std::size_t index) {
+        if (index == 0 || bank.size() < index) {
+            return std::nullopt;
+        }
+        return bank[index - 1];
+    }
+
+    /**
+     * @brief Return cached result of key or compute and cache it.
+     * @param key Normalized operation key.
+     * @param computation Callable computing result.
+     * @return Result.
+     */
+    template<class Computation>
+    MpInt<bytePrecision> cached(const std::string &key, Computation &&computation) {
+        if (auto result = resultCache.find(key)) {
+            return std::move(result.value());
         }
+        auto result = computation();
+        resultCache.insert(key, result);
         return result;
     }
 
     /**
-     * @brief Find term from string or return "nullopt" if result is from bank - above index.
-     * @param term String term to be resolved.
-     * @return Optional Term.
+     * @brief Apply unary operator. Factorial results are cached.
+     * @param oper Operator.
+     * @param a Operand.
+     * @return Result.
      */
-    std::optional<MpInt<bytePrecision>> getTerm(const std::string &term) {
-        if (term.starts_with('$')) {
-            auto index = term[1] - '1';
-            if (bank.getResults().size() <= index) {
-                return std::nullopt;
+    MpInt<bytePrecision> applyUnary(char oper, const MpInt<bytePrecision> &a) {
+        auto &operation = this->unaryOperatorMap.at(oper);
+        if (oper != '!') {
+            return operation(a);
+        }
+        // known factorial is kept in memory, so it is charged to budget of result cache even if computation fails
+        try {
+            auto result = cached(MpResultCache<bytePrecision>::makeKey(oper, a), [&] { return operation(a); });
+            resultCache.reserve(factorialCache.getSize());
+            return result;
+        } catch (...) {
+            resultCache.reserve(factorialCache.getSize());
+            throw;
+        }
+    }
+
+    /**
+     * @brief Apply binary operator. Multiplication and division results of large operands are cached.
+     * @param oper Operator.
+     * @param a First operand.
+     * @param b Second operand.
+     * @return Result.
+     */
+    MpInt<bytePrecision> applyBinary(char oper, const MpInt<bytePrecision> &a, const MpInt<bytePrecision> &b) {
+        auto &operation = this->binaryOperatorMap.at(oper);
+        if ((oper != '*' && oper != '/') || a.getCurrentCapacity() + b.getCurrentCapacity() < CACHE_MIN_BITS) {
+            return operation(a, b);
+        }
+        return cached(MpResultCache<bytePrecision>::makeKey(oper, a, b), [&] { return operation(a, b); });
+    }
+
+    /**
+     * @brief Apply function, results are cached.
+     * @param function Called function.
+     * @param name Name of function.
+     * @param arguments Arguments.
+     * @return Result.
+     */
+    MpInt<bytePrecision> applyFunction(const Function &function, std::string_view name,
+                                       const std::vector<MpInt<bytePrecision>> &arguments) {
+        return cached(MpResultCache<bytePrecision>::makeKey(name, arguments), [&] { return function.apply(arguments); });
+    }
+
+    /**
+     * @brief Evaluate expression tree or return "nullopt" if it references unknown bank item or calls unknown
+     * function (or with wrong count of arguments).
+     * @param expression Parsed expression.
+     * @return Optional result.
+     */
+    std::optional<MpInt<bytePrecision>> evaluate(const MpExpression &expression) {
+        switch (expression.getType()) {
+            case MpExpressionType::LITERAL:
+                return MpInt<bytePrecision>::fromDecimal(expression.getLiteral());
+            case MpExpressionType::BANK:
+                return getBankItem(expression.getBankIndex());
+            case MpExpressionType::UNARY: {
+                auto operand = evaluate(expression.getOperands()[0]);
+                if (!operand.has_value()) {
+                    return std::nullopt;
+                }
+                return applyUnary(expression.getOperator(), operand.value());
+            }
+            case MpExpressionType::BINARY: {
+                const auto &operands = expression.getOperands();
+                auto left = evaluate(operands[0]);
+                for (std::size_t i = 1; i < operands.size() && left.has_value(); i++) {
+                    auto right = evaluate(operands[i]);
+                    if (!right.has_value()) {
+                        return std::nullopt;
+                    }
+                    left = applyBinary(expression.getOperators()[i - 1], left.value(), right.value());
+                }
+                return left;
+            }
+            case MpExpressionType::FUNCTION: {
+                auto function = functionMap.find(expression.getName());
+                if (function == functionMap.end() || function->second.arity != expression.getOperands().size()) {
+                    return std::nullopt;
+                }
+                std::vector<MpInt<bytePrecision>> arguments;
+                for (const auto &operand: expression.getOperands()) {
+                    auto argument = evaluate(operand);
+                    if (!argument.has_value()) {
+                        return std::nullopt;
+                    }
+                    arguments.push_back(std::move(argument.value()));
+                }
+                return applyFunction(function->second, expression.getName(), arguments);
             }
-            return *bank.getResults()[index];
-        } else {
-            return MpInt<bytePrecision>(std::stoll(term));
         }
+        return std::nullopt;
     }
 
     /**
@@ -232,72 +423,357 @@ private:
     }
 
     /**
-     * @brief Process MpInt calculation
+     * @brief Check if command is "cache"
+     * @param command Terminal input.
+     * @return command == "cache"
+    */
+    bool isCacheCommand(const std::string &command) {
+        return command == "cache";
+    }
+
+    /**
+     * @brief Parse numeric argument of command "<name> <number>".
      * @param command Terminal input.
+     * @param name Name of command.
+     * @return Argument or "nullopt" if command is not name with number argument.
      */
-    void processCalculation(const std::string &command) {
-        std::array<std::string, 2> binaryTerms;
-        std::string unaryTerm;
-        char oper;
-        std::array<MpInt<bytePrecision>, 2> mpIntTerms;
-        if (std::regex_match(command, ADDITION_REG)) {
-            binaryTerms = split(command, '+');
-            oper = '+';
-        } else if (std::regex_match(command, SUBTRACT_REG)) {
-            binaryTerms = split(command, '-');
-            oper = '-';
-        } else if (std::regex_match(command, MULTIPLY_REG)) {
-            binaryTerms = split(command, '*');
-            oper = '*';
-        } else if (std::regex_match(command, DIVIDE_REG)) {
-            binaryTerms = split(command, '/');
-            oper = '/';
-        } else if (std::regex_match(command, FACTORIAL_REG)) {
-            oper = '!';
-            unaryTerm = trim(command);
-            unaryTerm = unaryTerm.substr(0, unaryTerm.length() - 1);
+    std::optional<std::size_t> getNumericArgument(const std::string &command, std::string_view name) {
+        if (!command.starts_with(name) || command.size() <= name.size() ||
+            !std::isspace(static_cast<unsigned char>(command[name.size()]))) {
+            return std::nullopt;
+        }
+        auto argument = trim(command.substr(name.size()));
+        if (argument.empty() || argument.size() > 9 || !std::all_of(argument.begin(), argument.end(), [](unsigned char ch) {
+            return std::isdigit(ch);
+        })) {
+            return std::nullopt;
+        }
+        return std::stoul(argument);
+    }
+
+    /**
+     * @brief Check if command is "stats"
+     * @param command Terminal input.
+     * @return command == "stats"
+    */
+    bool isStatsCommand(const std::string &command) {
+        return command == "stats";
+    }
+
+    /**
+     * @brief Check if command is "bank <size>" and parse the size.
+     * @param command Terminal input.
+     * @return New bank size or "nullopt" if command is not bank resize.
+     */
+    std::optional<std::size_t> getBankResize(const std::string &command) {
+        return getNumericArgument(command, "bank");
+    }
+
+    /**
+     * @brief Check if command is "timeout <seconds>" and parse the seconds.
+     * @param command Terminal input.
+     * @return New time limit or "nullopt" if command is not timeout setting.
+     */
+    std::optional<std::size_t> getTimeoutSetting(const std::string &command) {
+        return getNumericArgument(command, "timeout");
+    }
+
+    /**
+     * @brief Parse and evaluate expression. Throw MpIntException on overflow.
+     * @param command Terminal input.
+     * @return Result or "nullopt" if expression is unknown.
+     */
+    std::optional<MpInt<bytePrecision>> calculate(const std::string &command) {
+        auto expression = MpParser::parse(command);
+        if (!expression.has_value()) {
+            return std::nullopt;
+        }
+        MpStats::Timer timer(MpStatsOperation::EXPRESSION, 0);
+        return evaluate(expression.value());
+    }
+
+    /**
+     * @brief SIGINT handler requesting cancellation of running computation.
+     */
+    static void onInterrupt(int) {
+        interruptRequested = true;
+        std::signal(SIGINT, onInterrupt);
+    }
+
+    /**
+     * @brief Format message of overflow detected before computation.
+     * @param overflow Predicted overflow.
+     * @return Message without line end.
+     */
+    static std::string formatPredictedOverflow(const MpIntOverflowPredicted &overflow) {
+        return "Vysledek by mel alespon " + std::to_string(overflow.bits) + " bitu, presnost je " +
+               std::to_string(overflow.precision) + " bitu.";
+    }
+
+    /**
+     * @brief Format progress of running computation.
+     * @param progress Progress of computation.
+     * @return Progress line.
+     */
+    static std::string formatProgress(const MpProgress &progress) {
+        std::string line = "Probiha ";
+        auto operation = progress.getOperation();
+        line += operation != nullptr ? operation : "vypocet";
+        auto total = progress.getTotal();
+        if (total > 0) {
+            auto done = std::min(progress.getDone(), total);
+            line += ": " + std::to_string(done) + "/" + std::to_string(total) + " (" +
+                    std::to_string(done * 100 / total) + " %)";
         } else {
-            std::cout << "Neznamy vyraz." << std::endl;
-            return;
+            line += ": " + std::to_string(progress.getSteps()) + " kroku";
         }
-        try {
-            MpInt<bytePrecision> result;
-            if (oper == '!') {
-                auto term = getTerm(unaryTerm);
-                if (term.has_value()) {
-                    result = this->unaryOperatorMap[oper](term.value());
-                } else {
-                    std::cout << "Neznamy vyraz." << std::endl;
-                    return;
+        line += ", Ctrl+C prerusi";
+        line.resize(std::max(line.size(), PROGRESS_WIDTH), ' ');
+        return line;
+    }
+
+    /**
+     * @brief Process MpInt calculation. Expression is evaluated and printed on worker thread, while this thread
+     * reports progress to standard error and cancels computation on Ctrl+C or when time limit passes.
+     * @param command Terminal input.
+     */
+    void processCalculation(const std::string &command) {
+        MpProgress progress;
+        if (timeout.count() > 0) {
+            progress.setDeadline(std::chrono::steady_clock::now() + timeout);
+        }
+        std::mutex outputMutex;
+        bool outputStarted = false;
+        bool progressShown = false;
+        bool lineOpen = false;
+        auto sink = [&](std::string_view chunk) {
+            {
+                std::lock_guard lock(outputMutex);
+                if (!outputStarted && progressShown) {
+                    std::cerr << '\r' << std::string(PROGRESS_WIDTH, ' ') << '\r' << std::flush;
+                }
+                outputStarted = true;
+            }
+            std::cout.write(chunk.data(), static_cast<std::streamsize>(chunk.size()));
+            lineOpen = !chunk.empty() && chunk.back() != '\n';
+        };
+        auto computation = std::async(std::launch::async, [&]() -> std::optional<MpInt<bytePrecision>> {
+            MpProgress::Installer installer(progress);
+            try {
+                auto result = calculate(command);
+                if (!result.has_value()) {
+                    sink("Neznamy vyraz.\n");
+                    return std::nullopt;
                 }
+                result->writeDecimal(sink);
+                sink("\n");
+                return result;
+            } catch (MpIntOverflowPredicted &e) {
+                sink("Doslo k preteceni cisla.\n");
+                sink(formatPredictedOverflow(e));
+                sink("\n");
+                return std::nullopt;
+            } catch (MpIntException<MpInt<MP_INT_UNLIMITED>> &e) {
+                sink("Doslo k preteceni cisla.\n");
+                e.overflow.writeDecimal(sink);
+                sink("\n");
+                return std::nullopt;
+            } catch (std::invalid_argument &) {
+                sink("Neplatny argument funkce.\n");
+                return std::nullopt;
+            }
+        });
+        interruptRequested = false;
+        auto previousHandler = std::signal(SIGINT, onInterrupt);
+        while (computation.wait_for(PROGRESS_INTERVAL) != std::future_status::ready) {
+            if (interruptRequested) {
+                progress.cancel();
+            }
+            std::lock_guard lock(outputMutex);
+            if (!outputStarted) {
+                std::cerr << '\r' << formatProgress(progress) << std::flush;
+                progressShown = true;
+            }
+        }
+        std::signal(SIGINT, previousHandler);
+        try {
+            auto result = computation.get();
+            std::cout.flush();
+            if (result.has_value()) {
+                bank.push(std::move(result.value()));
+            }
+        } catch (MpIntCancelled &e) {
+            sink(lineOpen ? "\n" : "");
+            std::cout << (e.timeout ? "Vypocet prekrocil casovy limit." : "Vypocet byl prerusen.") << std::endl;
+        } catch (std::exception &e) {
+            // e.g. std::bad_alloc or failure of storage, the session continues
+            sink(lineOpen ? "\n" : "");
+            std::cout << "Vypocet selhal: " << e.what() << std::endl;
+        }
+    }
+
+    /**
+     * @brief Evaluate one batch line and write "<line number>\t<status>\t<value or message>\n" to sink.
+     * @tparam Sink Callable accepting std::string_view.
+     * @param lineNumber Number of line in input.
+     * @param expression Parsed expression or "nullopt" on syntax error.
+     * @param sink Receiver of output line.
+     * @return Result to be pushed to bank or "nullopt" on error.
+     */
+    template<class Sink>
+    std::optional<MpInt<bytePrecision>>
+    evaluateLine(std::size_t lineNumber, const std::optional<MpExpression> &expression, Sink &&sink) {
+        std::optional<MpInt<bytePrecision>> result;
+        sink(std::to_string(lineNumber));
+        MpProgress progress;
+        if (timeout.count() > 0) {
+            progress.setDeadline(std::chrono::steady_clock::now() + timeout);
+        }
+        MpProgress::Installer installer(progress);
+        try {
+            if (expression.has_value()) {
+                MpStats::Timer timer(MpStatsOperation::EXPRESSION, 0);
+                result = evaluate(expression.value());
+            }
+            if (result.has_value()) {
+                sink("\tOK\t");
+                result->writeDecimal(sink);
             } else {
-                auto term1 = getTerm(binaryTerms[0]);
-                auto term2 = getTerm(binaryTerms[1]);
-                if (term1.has_value() && term2.has_value()) {
-                    result = this->binaryOperatorMap[oper](term1.value(), term2.value());
-                } else {
-                    std::cout << "Neznamy vyraz." << std::endl;
+                sink("\tERROR\tNeznamy vyraz.");
+            }
+        } catch (MpIntOverflowPredicted &e) {
+            sink("\tOVERFLOW\t");
+            sink(formatPredictedOverflow(e));
+        } catch (MpIntException<MpInt<MP_INT_UNLIMITED>> &e) {
+            sink("\tOVERFLOW\t");
+            e.overflow.writeDecimal(sink);
+        } catch (MpIntCancelled &) {
+            result.reset();
+            sink("\tERROR\tVypocet prekrocil casovy limit.");
+        } catch (std::exception &e) {
+            sink("\tERROR\t");
+            sink(e.what());
+        }
+        sink("\n");
+        return result;
+    }
+
+    /**
+     * @brief Evaluate batch task, store its result and formatted output.
+     * @param task Batch task.
+     */
+    void evaluateTask(BatchTask &task) {
+        task.result = evaluateLine(task.lineNumber, task.expression,
+                                   [&task](std::string_view chunk) { task.output += chunk; });
+    }
+
+    /**
+     * @brief Evaluate batch in pipeline: this thread reads and parses lines, worker threads evaluate lines without
+     * bank references and writer thread evaluates lines with bank references in input order, writes outputs in
+     * input order and pushes results to bank.
+     * @param input Source of expressions.
+     * @param output Receiver of results.
+     * @param threads Count of worker threads.
+     */
+    void runParallelBatch(std::istream &input, std::ostream &output, std::size_t threads) {
+        std::mutex mutex;
+        std::condition_variable readerCondition, workerCondition, writerCondition;
+        std::deque<std::unique_ptr<BatchTask>> window;
+        std::deque<BatchTask *> pending;
+        bool inputFinished = false;
+        const std::size_t capacity = threads * BATCH_WINDOW_PER_THREAD;
+        auto tiedOutput = input.tie(nullptr);
+
+        std::vector<std::thread> workers;
+        for (std::size_t i = 0; i < threads; i++) {
+            workers.emplace_back([&] {
+                std::unique_lock lock(mutex);
+                while (true) {
+                    workerCondition.wait(lock, [&] { return !pending.empty() || inputFinished; });
+                    if (pending.empty()) {
+                        return;
+                    }
+                    auto task = pending.front();
+                    pending.pop_front();
+                    lock.unlock();
+                    evaluateTask(*task);
+                    lock.lock();
+                    task->done = true;
+                    writerCondition.notify_one();
+                }
+            });
+        }
+        std::thread writer([&] {
+            std::unique_lock lock(mutex);
+            while (true) {
+                writerCondition.wait(lock, [&] {
+                    return (!window.empty() && (window.front()->done || window.front()->isOrdered())) ||
+                           (window.empty() && inputFinished);
+                });
+                if (window.empty()) {
                     return;
                 }
+                auto task = std::move(window.front());
+                window.pop_front();
+                readerCondition.notify_one();
+                lock.unlock();
+                if (!task->done) {
+                    evaluateTask(*task);
+                }
+                if (task->result.has_value()) {
+                    bank.push(std::move(task->result.value()));
+                }
+                output << task->output;
+                lock.lock();
             }
-            bank.push(result);
-            std::cout << result.toDecimal() << std::endl;
-        } catch (MpIntException<MpInt<MP_INT_UNLIMITED>> &e) {
-            std::cout << "Doslo k preteceni cisla." << std::endl;
-            std::cout << e.overflow.toDecimal() << std::endl;
+        });
+
+        std::string line;
+        std::size_t lineNumber = 0;
+        while (std::getline(input, line)) {
+            lineNumber++;
+            auto command = trim(line);
+            if (command.empty()) {
+                continue;
+            }
+            if (isExitCommand(command)) {
+                break;
+            }
+            auto task = std::make_unique<BatchTask>();
+            task->lineNumber = lineNumber;
+            task->expression = MpParser::parse(command);
+            std::unique_lock lock(mutex);
+            readerCondition.wait(lock, [&] { return window.size() < capacity; });
+            if (!task->isOrdered()) {
+                pending.push_back(task.get());
+                workerCondition.notify_one();
+            }
+            window.push_back(std::move(task));
+            writerCondition.notify_one();
         }
+        {
+            std::lock_guard lock(mutex);
+            inputFinished = true;
+        }
+        workerCondition.notify_all();
+        writerCondition.notify_all();
+        for (auto &worker: workers) {
+            worker.join();
+        }
+        writer.join();
+        output.flush();
+        input.tie(tiedOutput);
     }
 
     /**
      * @brief Print all items of bank on terminal.
      */
     void printBank() {
-        if (bank.getResults().empty()) {
+        if (bank.empty()) {
             std::cout << "Banka je prazdna!" << std::endl;
         } else {
-            std::size_t index = 0;
-            for (MpInt<bytePrecision> *item: bank.getResults()) {
-                std::cout << "$" << ++index << ": " << item->toDecimal() << std::endl;
+            for (std::size_t index = 0; index < bank.size(); index++) {
+                std::cout << "$" << index + 1 << ": " << bank[index] << std::endl;
             }
         }
     }
@@ -349,7 +825,29 @@ private:
                    "--------------------------------------------------------------------------------------------------------------------"
                 << std::endl;
         std::cout << "Vitejte v kalkulacce na neomezena cisla." << std::endl;
-        std::cout << "Zadejte jednoduchy matematicky vyraz s nejvyse jednou operaci +, -, *, / nebo !." << std::endl;
+        std::cout << "Zadejte matematicky vyraz s operacemi +, -, *, /, !, zavorkami a odkazy do banky $1, $2, ..."
+                  << std::endl;
+        std::cout << "Funkce: fib(n), binomial(n, k), multifactorial(n, m)." << std::endl;
+        std::cout << "Prikazy: bank, bank <velikost>, cache, stats, timeout <sekundy>, exit. Dlouhy vypocet prerusite Ctrl+C."
+                  << std::endl;
+    }
+
+    /**
+     * @brief Resize bank and print its new size, or error if size is above MAX_BANK_SIZE or memory is exhausted.
+     * @param size New bank size.
+     */
+    void resizeBank(std::size_t size) {
+        if (size > MAX_BANK_SIZE) {
+            std::cout << "Velikost banky muze byt nejvyse " << MAX_BANK_SIZE << "." << std::endl;
+            return;
+        }
+        try {
+            bank.resize(size);
+        } catch (std::bad_alloc &) {
+            std::cout << "Nedostatek pameti pro banku." << std::endl;
+            return;
+        }
+        std::cout << "Velikost banky: " << size << std::endl;
     }
 
     /**
@@ -363,6 +861,14 @@ private:
     }
 
 public:
+    /**
+     * @brief Set time limit of one computation (interactive expression or batch line).
+     * @param limit Time limit, zero for none.
+     */
+    void setTimeout(std::chrono::seconds limit) {
+        timeout = limit;
+    }
+
     /**
      * @brief Run application loop.
      */
@@ -377,10 +883,54 @@ public:
                 break;
             } else if (isBankCommand(command)) {
                 printBank();
+            } else if (isCacheCommand(command)) {
+                resultCache.printStatistics(std::cout);
+            } else if (isStatsCommand(command)) {
+                MpStats::print(std::cout);
+            } else if (auto bankSize = getBankResize(command)) {
+                resizeBank(bankSize.value());
+            } else if (auto seconds = getTimeoutSetting(command)) {
+                setTimeout(std::chrono::seconds(seconds.value()));
+                std::cout << "Casovy limit: " << (seconds.value() == 0 ? "zadny" : std::to_string(seconds.value()) + " s")
+                          << std::endl;
             } else {
                 processCalculation(command);
             }
         }
         std::cout << "Dekujeme za vyuziti nasi kalkulacky! :)" << std::endl;
     }
+
+    /**
+     * @brief Run non-interactive evaluation of expressions, one per line, until end of input or "exit".
+     * Every nonempty line produces one output line "<line number>\t<status>\t<value or message>" where status is
+     * OK, OVERFLOW (value is the overflowed result) or ERROR. Errors do not stop processing. With more threads,
+     * independent lines are evaluated in parallel while output order and bank semantics are kept.
+     * @param input Source of expressions.
+     * @param output Receiver of results.
+     * @param threads Count of worker threads.
+     */
+    void runBatch(std::istream &input, std::ostream &output, std::size_t threads = 1) {
+        if (threads > 1) {
+            runParallelBatch(input, output, threads);
+            return;
+        }
+        auto sink = [&output](std::string_view chunk) { output.write(chunk.data(), chunk.size()); };
+        std::string line;
+        std::size_t lineNumber = 0;
+        while (std::getline(input, line)) {
+            lineNumber++;
+            auto command = trim(line);
+            if (command.empty()) {
+                continue;
+            }
+            if (isExitCommand(command)) {
+                break;
+            }
+            auto result = evaluateLine(lineNumber, MpParser::parse(command), sink);
+            if (result.has_value()) {
+                bank.push(std::move(result.value()));
+            }
+        }
+        output.flush();
+    }
 };
\ No newline at end of file
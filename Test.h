@@ -1,8 +1,22 @@
-
+#include <algorithm>
+#include <chrono>
+#include <functional>
 #include <iostream>
 #include <limits>
 #include <random>
+#include <sstream>
+#include <thread>
+#include "MpAccumulator.h"
+#include "MpCombinatorics.h"
+#include "MpConstants.h"
+#include "MpDecimal.h"
+#include "MpExpression.h"
 #include "MpInt.h"
+#include "MpPrime.h"
+#include "MpProduct.h"
+#include "MpRandom.h"
+#include "MpRns.h"
+#include "MpTerm.h"
 
 #undef COLORED
 
@@ -176,6 +190,41 @@ void testOverflow(std::size_t &testSuccess, std::size_t &testFailed) {
 }
 
 
+void testPredictedOverflow(std::size_t &success, std::size_t &failed) {
+    std::cout << std::endl;
+    std::cout << printInfo("Predicted overflow testing") << std::endl;
+    // small overflows keep exact value
+    try {
+        [[maybe_unused]] auto overflow = MpInt<8>(21LL).factorial();
+        failed++;
+        std::cout << printWrong("Test failed") << std::endl;
+    } catch (MpIntException<MpInt<MP_INT_UNLIMITED>> &e) {
+        if (e.overflow.toDecimal() == "51090942171709440000") {
+            success++;
+            std::cout << printRight("Test OK") << std::endl;
+        } else {
+            failed++;
+            std::cout << printWrong("Test failed") << std::endl;
+        }
+    }
+    // large overflows are rejected before computation
+    MpInt<MP_INT_UNLIMITED> known(1LL);
+    MpInt<MP_INT_UNLIMITED> knownFactorial(1LL);
+    try {
+        [[maybe_unused]] auto overflow = MpInt<4>(1000000000LL).factorial(known, knownFactorial);
+        failed++;
+        std::cout << printWrong("Test failed") << std::endl;
+    } catch (MpIntOverflowPredicted &e) {
+        if (e.bits > 28000000000ULL && e.precision == 32 && known == MpInt<4>(1LL)) {
+            success++;
+            std::cout << printRight("Test OK") << std::endl;
+        } else {
+            failed++;
+            std::cout << printWrong("Test failed") << std::endl;
+        }
+    }
+}
+
 void testRandomInts(std::size_t &success, std::size_t &failed) {
     std::random_device rd;
     std::size_t iterationSuccess, iterationFailed;
@@ -302,13 +351,743 @@ void testFactorial(std::size_t &success, std::size_t &failed) {
     }
 }
 
+void testOutput(std::size_t &success, std::size_t &failed) {
+    std::cout << std::endl;
+    std::cout << printInfo("Streaming output testing") << std::endl;
+    std::ostringstream stream;
+    stream << MpInt<8>(-1234567LL) << ' ' << std::hex << MpInt<MP_INT_UNLIMITED>(longLongMin);
+    std::string grouped;
+    MpInt<MP_INT_UNLIMITED>(1234567LL).writeDecimal([&grouped](std::string_view chunk) { grouped += chunk; }, ',');
+    if (stream.str() == "-1234567 -8000000000000000" && grouped == "1,234,567") {
+        success++;
+        std::cout << printRight("Test OK") << std::endl;
+    } else {
+        failed++;
+        std::cout << printWrong("Test failed") << std::endl;
+    }
+}
+
+void testRadix(std::size_t &success, std::size_t &failed) {
+    std::cout << std::endl;
+    std::cout << printInfo("Power-of-two radix conversion testing") << std::endl;
+    auto a = MpInt<MP_INT_UNLIMITED>(100).factorial();
+    auto b = MpInt<MP_INT_UNLIMITED>(0LL) - a;
+    auto roundTrip = true;
+    for (unsigned bits = 1; bits <= MAX_RADIX_BITS; bits++) {
+        roundTrip = roundTrip &&
+                    MpInt<MP_INT_UNLIMITED>::fromRadix(a.toRadix(bits), bits).toDecimal() == a.toDecimal() &&
+                    MpInt<MP_INT_UNLIMITED>::fromRadix(b.toRadix(bits), bits).toDecimal() == b.toDecimal();
+    }
+    if (roundTrip && MpInt<8>::fromHex("-0x8000000000000000") == MpInt<8>(longLongMin) &&
+        MpInt<8>(longLongMin).toHex() == "-8000000000000000") {
+        success++;
+        std::cout << printRight("Test OK") << std::endl;
+    } else {
+        failed++;
+        std::cout << printWrong("Test failed") << std::endl;
+    }
+    try {
+        MpInt<8>::fromHex("8000000000000000");
+        failed++;
+        std::cout << printWrong("Test failed") << std::endl;
+    } catch (MpIntException<MpInt<MP_INT_UNLIMITED>> &e) {
+        if (e.overflow.toDecimal() == "9223372036854775808") {
+            success++;
+            std::cout << printRight("Test OK") << std::endl;
+        } else {
+            failed++;
+            std::cout << printWrong("Test failed") << std::endl;
+        }
+    }
+}
+
+void testDecimalParsing(std::size_t &success, std::size_t &failed) {
+    std::cout << std::endl;
+    std::cout << printInfo("Decimal parsing testing") << std::endl;
+    const std::string digits =
+            "-93326215443944152681699238856266700490715968264381621468592963895217599993229915608941463976156518286253697920827223758251185210916864000000000000000000000000";
+    if (MpInt<MP_INT_UNLIMITED>::fromDecimal(digits).toDecimal() == digits &&
+        MpInt<8>::fromDecimal("-9223372036854775808") == MpInt<8>(longLongMin)) {
+        success++;
+        std::cout << printRight("Test OK") << std::endl;
+    } else {
+        failed++;
+        std::cout << printWrong("Test failed") << std::endl;
+    }
+}
+
+void testParser(std::size_t &success, std::size_t &failed) {
+    std::cout << std::endl;
+    std::cout << printInfo("Parser testing") << std::endl;
+    // evaluates literals and binary chains only
+    std::function<MpInt<8>(const MpExpression &)> evaluate = [&evaluate](const MpExpression &expression) {
+        if (expression.getType() == MpExpressionType::LITERAL) {
+            return MpInt<8>::fromDecimal(expression.getLiteral());
+        }
+        auto result = evaluate(expression.getOperands()[0]);
+        for (std::size_t i = 1; i < expression.getOperands().size(); i++) {
+            auto operand = evaluate(expression.getOperands()[i]);
+            switch (expression.getOperators()[i - 1]) {
+                case '+':
+                    result = result + operand;
+                    break;
+                case '-':
+                    result = result - operand;
+                    break;
+                case '*':
+                    result = result * operand;
+                    break;
+                default:
+                    result = result / operand;
+            }
+        }
+        return result;
+    };
+    auto value = [&evaluate](std::string_view input) {
+        auto expression = MpParser::parse(input);
+        return expression.has_value() ? evaluate(expression.value()) : MpInt<8>(-1LL);
+    };
+    // precedence and left associativity
+    auto ok = value("2 + 3 * 4") == MpInt<8>(14LL) && value("2 * 3 + 4") == MpInt<8>(10LL) &&
+              value("(2 + 3) * 4") == MpInt<8>(20LL) && value("10 - 4 - 3") == MpInt<8>(3LL) &&
+              value("100 / 10 / 5") == MpInt<8>(2LL) && value("10 - 2 * 3 - 1") == MpInt<8>(3LL);
+    auto chain = MpParser::parse("10 - 4 - 3");
+    ok = ok && chain.has_value() && chain->getType() == MpExpressionType::BINARY && chain->getOperators() == "--" &&
+         chain->getOperands().size() == 3;
+    // -5! is -(5!)
+    auto negated = MpParser::parse("-5!");
+    ok = ok && negated.has_value() && negated->getType() == MpExpressionType::UNARY &&
+         negated->getOperator() == '-' && negated->getOperands()[0].getType() == MpExpressionType::UNARY &&
+         negated->getOperands()[0].getOperator() == '!' &&
+         negated->getOperands()[0].getOperands()[0].getLiteral() == "5";
+    // bank references of any index below the limit
+    auto bank = MpParser::parse("$1 + $123456789");
+    ok = ok && bank.has_value() && bank->getOperands()[0].getBankIndex() == 1 &&
+         bank->getOperands()[1].getBankIndex() == 123456789 && !MpParser::parse("$12345678901").has_value() &&
+         !MpParser::parse("$").has_value();
+    // negation of literal is folded, so that bounded minimum is representable
+    auto minimum = MpParser::parse("-9223372036854775808");
+    ok = ok && minimum.has_value() && minimum->getType() == MpExpressionType::LITERAL &&
+         MpInt<8>::fromDecimal(minimum->getLiteral()) == MpInt<8>(longLongMin) &&
+         value("--9223372036854775807") == MpInt<8>(longLongMax);
+    // nesting is limited, flat chains are not
+    auto nested = [](std::size_t depth) {
+        return std::string(depth, '(') + "1" + std::string(depth, ')');
+    };
+    std::string flat = "1";
+    for (std::size_t i = 1; i < 2 * MAX_EXPRESSION_DEPTH; i++) {
+        flat += i % 2 == 0 ? "+1" : "-1";
+    }
+    auto flatChain = MpParser::parse(flat);
+    ok = ok && MpParser::parse(nested(MAX_EXPRESSION_DEPTH)).has_value() &&
+         !MpParser::parse(nested(MAX_EXPRESSION_DEPTH + 1)).has_value() &&
+         !MpParser::parse(std::string(MAX_EXPRESSION_DEPTH + 1, '-') + "1").has_value() &&
+         !MpParser::parse("1" + std::string(MAX_EXPRESSION_DEPTH + 1, '!')).has_value() &&
+         flatChain.has_value() && flatChain->getHeight() == 2 && evaluate(flatChain.value()) == MpInt<8>(0LL);
+    ok = ok && !MpParser::parse("1 +").has_value() && !MpParser::parse("(1").has_value() &&
+         !MpParser::parse("1 2").has_value() && !MpParser::parse("").has_value();
+    // function calls take any count of arguments and count to nesting
+    auto call = MpParser::parse("binomial(fib(5), 2 + 1) * 2");
+    std::string calls;
+    for (std::size_t i = 0; i <= MAX_EXPRESSION_DEPTH; i++) {
+        calls += "fib(";
+    }
+    calls += "1" + std::string(MAX_EXPRESSION_DEPTH + 1, ')');
+    ok = ok && call.has_value() && call->getOperands()[0].getType() == MpExpressionType::FUNCTION &&
+         call->getOperands()[0].getName() == "binomial" && call->getOperands()[0].getOperands().size() == 2 &&
+         !MpParser::parse("fib 5").has_value() && !MpParser::parse("fib(5,)").has_value() &&
+         !MpParser::parse(calls).has_value();
+    if (ok) {
+        success++;
+        std::cout << printRight("Test OK") << std::endl;
+    } else {
+        failed++;
+        std::cout << printWrong("Test failed") << std::endl;
+    }
+}
+
+void testBatch(std::size_t &success, std::size_t &failed) {
+    std::cout << std::endl;
+    std::cout << printInfo("Batch testing") << std::endl;
+    auto batch = [](auto &&term, const std::string &text, std::size_t threads) {
+        std::istringstream input(text);
+        std::ostringstream output;
+        term.runBatch(input, output, threads);
+        return output.str();
+    };
+    // empty lines are skipped, errors do not stop processing, "exit" does
+    auto ok = batch(MpTerm<MP_INT_UNLIMITED>(), "1 + 2\n\n2 * $1\n(1\n$9\n1 / 0\n3!\nexit\n4\n", 1) ==
+              "1\tOK\t3\n3\tOK\t6\n4\tERROR\tNeznamy vyraz.\n5\tERROR\tNeznamy vyraz.\n6\tOVERFLOW\t0\n7\tOK\t6\n" &&
+              batch(MpTerm<8>(), "9223372036854775807 + 1\n-9223372036854775808\n", 1) ==
+                      "1\tOVERFLOW\t9223372036854775808\n2\tOK\t-9223372036854775808\n";
+    // parallel evaluation writes the same output, lines with bank references depend on previous results
+    std::string lines;
+    for (std::size_t i = 0; i < 3000; i++) {
+        auto number = std::to_string(i);
+        switch (i % 5) {
+            case 0:
+                lines += number + " * 12345678901234567890\n";
+                break;
+            case 1:
+                lines += "$1 + $2\n";
+                break;
+            case 2:
+                lines += "(" + number + "\n";
+                break;
+            case 3:
+                lines += "$3 * 2 - " + number + "\n";
+                break;
+            default:
+                lines += std::to_string(i % 40) + "!\n";
+        }
+    }
+    auto serial = batch(MpTerm<MP_INT_UNLIMITED>(), lines, 1);
+    ok = ok && std::count(serial.begin(), serial.end(), '\n') == 3000 &&
+         serial == batch(MpTerm<MP_INT_UNLIMITED>(), lines, 8) && serial == batch(MpTerm<MP_INT_UNLIMITED>(), lines, 2);
+    if (ok) {
+        success++;
+        std::cout << printRight("Test OK") << std::endl;
+    } else {
+        failed++;
+        std::cout << printWrong("Test failed") << std::endl;
+    }
+}
+
+void testCache(std::size_t &success, std::size_t &failed) {
+    std::cout << std::endl;
+    std::cout << printInfo("Cache testing") << std::endl;
+    using Unlimited = MpInt<MP_INT_UNLIMITED>;
+    using Cache = MpResultCache<MP_INT_UNLIMITED>;
+    Unlimited a(2LL), b(3LL);
+    // keys of the same length and values of the same size, budget holds two entries
+    auto product = Cache::makeKey('*', a, b), sum = Cache::makeKey('+', a, b), difference = Cache::makeKey('-', a, b);
+    Cache cache(2 * (product.size() + a.getCurrentCapacity() / 8 + CACHE_ENTRY_OVERHEAD) + 1);
+    cache.insert(product, Unlimited(6LL));
+    cache.insert(sum, Unlimited(5LL));
+    // commutative operands share key, lookup makes product the most recently used entry
+    auto ok = Cache::makeKey('*', b, a) == product && Cache::makeKey('-', b, a) != difference &&
+              cache.find(Cache::makeKey('*', b, a)) == Unlimited(6LL);
+    cache.insert(difference, Unlimited(-1LL));
+    ok = ok && !cache.find(sum).has_value() && cache.find(product) == Unlimited(6LL) &&
+         cache.find(difference) == Unlimited(-1LL);
+    // reserved memory evicts entries and blocks insertion
+    cache.reserve(CACHE_BUDGET);
+    cache.insert(sum, Unlimited(5LL));
+    ok = ok && !cache.find(product).has_value() && !cache.find(sum).has_value();
+    cache.reserve(0);
+    cache.insert(sum, Unlimited(5LL));
+    ok = ok && cache.find(sum) == Unlimited(5LL);
+    // factorial cache continues from the largest kept factorial within its budget
+    MpFactorialCache factorials;
+    ok = ok && factorials.get(Unlimited(30LL)) == Unlimited(30LL).factorial() &&
+         factorials.getKnown() == Unlimited(30LL) && factorials.get(MpInt<8>(20LL)) == MpInt<8>(20LL).factorial() &&
+         factorials.getKnown() == Unlimited(30LL) &&
+         factorials.get(Unlimited(40LL)) == Unlimited(40LL).factorial() && factorials.getSize() > 0;
+    MpFactorialCache small(1);
+    ok = ok && small.get(Unlimited(30LL)) == Unlimited(30LL).factorial() && small.getKnown() == Unlimited(1LL) &&
+         small.getSize() == 0;
+    if (ok) {
+        success++;
+        std::cout << printRight("Test OK") << std::endl;
+    } else {
+        failed++;
+        std::cout << printWrong("Test failed") << std::endl;
+    }
+}
+
+void testRingBuffer(std::size_t &success, std::size_t &failed) {
+    std::cout << std::endl;
+    std::cout << printInfo("Ring buffer testing") << std::endl;
+    MpTerm<8>::RingBuffer buffer(3);
+    for (long long i = 1; i <= 4; i++) {
+        buffer.push(MpInt<8>(i));
+    }
+    // index 0 is the newest item, the oldest one was overwritten
+    auto ok = buffer.size() == 3 && buffer[0] == MpInt<8>(4LL) && buffer[1] == MpInt<8>(3LL) &&
+              buffer[2] == MpInt<8>(2LL);
+    buffer.resize(5);
+    buffer.push(MpInt<8>(5LL));
+    ok = ok && buffer.size() == 4 && buffer[0] == MpInt<8>(5LL) && buffer[3] == MpInt<8>(2LL);
+    buffer.resize(2);
+    ok = ok && buffer.size() == 2 && buffer[0] == MpInt<8>(5LL) && buffer[1] == MpInt<8>(4LL);
+    buffer.resize(0);
+    buffer.push(MpInt<8>(6LL));
+    ok = ok && buffer.empty();
+    buffer.resize(2);
+    buffer.push(MpInt<8>(7LL));
+    ok = ok && buffer.size() == 1 && buffer[0] == MpInt<8>(7LL);
+    if (ok) {
+        success++;
+        std::cout << printRight("Test OK") << std::endl;
+    } else {
+        failed++;
+        std::cout << printWrong("Test failed") << std::endl;
+    }
+}
+
+void testCancellation(std::size_t &success, std::size_t &failed) {
+    std::cout << std::endl;
+    std::cout << printInfo("Cancellation testing") << std::endl;
+    using Unlimited = MpInt<MP_INT_UNLIMITED>;
+    MpFactorialCache factorials;
+    auto ok = true;
+    MpProgress expiring;
+    expiring.setDeadline(std::chrono::steady_clock::now() + std::chrono::milliseconds(50));
+    try {
+        MpProgress::Installer installer(expiring);
+        [[maybe_unused]] auto value = factorials.get(Unlimited(100'000'000LL));
+        ok = false;
+    } catch (MpIntCancelled &e) {
+        ok = e.timeout;
+    }
+    // partial progress is kept, known number and its factorial stay consistent
+    auto known = factorials.getKnown();
+    ok = ok && known > Unlimited(1LL) && factorials.get(known + Unlimited(1LL)) ==
+                                         known.factorial() * (known + Unlimited(1LL));
+    MpProgress cancelled;
+    cancelled.cancel();
+    try {
+        MpProgress::Installer installer(cancelled);
+        [[maybe_unused]] auto value = factorials.get(Unlimited(100'000'000LL));
+        ok = false;
+    } catch (MpIntCancelled &e) {
+        ok = ok && !e.timeout;
+    }
+    ok = ok && factorials.getKnown() == known + Unlimited(1LL) && MpProgress::getCurrent() == nullptr;
+    if (ok) {
+        success++;
+        std::cout << printRight("Test OK") << std::endl;
+    } else {
+        failed++;
+        std::cout << printWrong("Test failed") << std::endl;
+    }
+}
+
+void testComparison(std::size_t &success, std::size_t &failed) {
+    std::cout << std::endl;
+    std::cout << printInfo("Comparison testing") << std::endl;
+    // ascending values with different signs and counts of limbs
+    const std::vector<MpInt<MP_INT_UNLIMITED>> values = {
+            MpInt<MP_INT_UNLIMITED>::fromHex("-100000000000000000000000000000000"),
+            MpInt<MP_INT_UNLIMITED>::fromHex("-ffffffffffffffffffffffffffffffff"),
+            MpInt<MP_INT_UNLIMITED>::fromHex("-10000000000000001"),
+            MpInt<MP_INT_UNLIMITED>(longLongMin),
+            MpInt<MP_INT_UNLIMITED>(-1LL),
+            MpInt<MP_INT_UNLIMITED>(0LL),
+            MpInt<MP_INT_UNLIMITED>(1LL),
+            MpInt<MP_INT_UNLIMITED>(2LL),
+            MpInt<MP_INT_UNLIMITED>::fromHex("ffffffffffffffff"),
+            MpInt<MP_INT_UNLIMITED>::fromHex("10000000000000000")};
+    auto ordered = true;
+    for (std::size_t i = 0; i < values.size(); i++) {
+        for (std::size_t j = 0; j < values.size(); j++) {
+            ordered = ordered && (values[i] <=> values[j]) == (i <=> j) && (values[i] == values[j]) == (i == j) &&
+                      (values[i] < values[j]) == (i < j) && (values[i] >= values[j]) == (i >= j);
+        }
+    }
+    if (ordered && MpInt<8>(-5LL) < MpInt<MP_INT_UNLIMITED>(3LL) && MpInt<8>(7LL) == MpInt<MP_INT_UNLIMITED>(7LL) &&
+        MpInt<MP_INT_UNLIMITED>(7LL) > MpInt<4>(-7LL)) {
+        success++;
+        std::cout << printRight("Test OK") << std::endl;
+    } else {
+        failed++;
+        std::cout << printWrong("Test failed") << std::endl;
+    }
+}
+
+void testMixedPrecision(std::size_t &success, std::size_t &failed) {
+    std::cout << std::endl;
+    std::cout << printInfo("Mixed precision testing") << std::endl;
+    auto big = MpInt<MP_INT_UNLIMITED>::fromHex("100000000000000000000000000000000");
+    auto ok = MpInt<4>(-5LL) + big == MpInt<MP_INT_UNLIMITED>::fromHex("fffffffffffffffffffffffffffffffb") &&
+              MpInt<4>(5LL) - big == MpInt<MP_INT_UNLIMITED>::fromHex("-fffffffffffffffffffffffffffffffb") &&
+              MpInt<16>(-3LL) - MpInt<8>(longLongMin) == MpInt<16>(longLongMax - 2) &&
+              MpInt<4>(MpInt<16>(-123456789LL)) == MpInt<8>(-123456789LL) &&
+              MpInt<MP_INT_UNLIMITED>(MpInt<8>(longLongMin)) == MpInt<4>(longLongMin);
+    MpInt<8> moved(-42LL);
+    MpInt<MP_INT_UNLIMITED> adopted(std::move(moved));
+    ok = ok && adopted == MpInt<4>(-42LL);
+    // sum and difference overflowing precision carry exact value
+    for (auto subtract: {false, true}) {
+        try {
+            [[maybe_unused]] auto result = subtract ? MpInt<8>(longLongMin) - MpInt<4>(1LL)
+                                                    : MpInt<8>(longLongMin) + MpInt<8>(longLongMin);
+            ok = false;
+        } catch (MpIntException<MpInt<MP_INT_UNLIMITED>> &e) {
+            ok = ok && e.overflow == (subtract ? MpInt<MP_INT_UNLIMITED>::fromHex("-8000000000000001")
+                                               : MpInt<MP_INT_UNLIMITED>::fromHex("-10000000000000000"));
+        }
+    }
+    if (ok) {
+        success++;
+        std::cout << printRight("Test OK") << std::endl;
+    } else {
+        failed++;
+        std::cout << printWrong("Test failed") << std::endl;
+    }
+}
+
+void testAccumulator(std::size_t &success, std::size_t &failed) {
+    std::cout << std::endl;
+    std::cout << printInfo("Accumulator testing") << std::endl;
+    std::mt19937_64 engine(7);
+    MpInt<MP_INT_UNLIMITED> expected(0LL);
+    std::array<MpAccumulator, 4> partial;
+    for (int i = 0; i < 4000; i++) {
+        auto value = MpInt<MP_INT_UNLIMITED>(static_cast<long long>(engine()));
+        if (i % 3 == 0) {
+            value = value * value * MpInt<MP_INT_UNLIMITED>(static_cast<long long>(engine()));
+        }
+        expected = expected + value;
+        partial[i % partial.size()] += value;
+    }
+    partial[0] += MpInt<8>(longLongMin);
+    partial[1] += -5LL;
+    expected = expected + MpInt<8>(longLongMin) - MpInt<4>(5LL);
+    for (std::size_t i = 1; i < partial.size(); i++) {
+        partial[0].merge(partial[i]);
+    }
+    MpAccumulator small;
+    small += MpInt<8>(longLongMin);
+    small += MpInt<8>(longLongMin);
+    if (partial[0].get() == expected && small.get() == MpInt<MP_INT_UNLIMITED>(longLongMin) * MpInt<4>(2LL) &&
+        MpAccumulator().get() == MpInt<4>(0LL)) {
+        success++;
+        std::cout << printRight("Test OK") << std::endl;
+    } else {
+        failed++;
+        std::cout << printWrong("Test failed") << std::endl;
+    }
+    try {
+        [[maybe_unused]] auto overflow = small.get<8>();
+        failed++;
+        std::cout << printWrong("Test failed") << std::endl;
+    } catch (MpIntException<MpInt<MP_INT_UNLIMITED>> &e) {
+        if (e.overflow.toDecimal() == "-18446744073709551616") {
+            success++;
+            std::cout << printRight("Test OK") << std::endl;
+        } else {
+            failed++;
+            std::cout << printWrong("Test failed") << std::endl;
+        }
+    }
+}
+
+void testProduct(std::size_t &success, std::size_t &failed) {
+    std::cout << std::endl;
+    std::cout << printInfo("Product tree testing") << std::endl;
+    auto numbers = std::views::iota(1, 301);
+    std::vector<MpInt<MP_INT_UNLIMITED>> values = {MpInt<MP_INT_UNLIMITED>(100).factorial(),
+                                                   MpInt<MP_INT_UNLIMITED>(-3LL), MpInt<MP_INT_UNLIMITED>(longLongMin),
+                                                   MpInt<MP_INT_UNLIMITED>(7LL)};
+    auto expected = values[0] * values[1] * values[2] * values[3];
+    // helper threads share progress of the calling thread, work beyond the thread budget runs in the calling thread
+    auto threads = MpProgress::getThreads();
+    MpProgress progress;
+    bool helpers;
+    {
+        MpProgress::Installer installer(progress);
+        auto run = [] { return std::make_pair(std::this_thread::get_id(), MpProgress::getCurrent()); };
+        MpProgress::setThreads(1);
+        auto deferred = MpProgress::launch(run).get();
+        MpProgress::setThreads(2);
+        auto helper = MpProgress::launch(run).get();
+        helpers = deferred.first == std::this_thread::get_id() && helper.first != std::this_thread::get_id() &&
+                  deferred.second == &progress && helper.second == &progress;
+    }
+    MpProgress::setThreads(threads);
+    if (helpers && MpProduct::product(numbers) == MpInt<MP_INT_UNLIMITED>(300).factorial() &&
+        MpProduct::product(numbers, MpProductOrder::HUFFMAN) == MpInt<MP_INT_UNLIMITED>(300).factorial() &&
+        MpProduct::product(values) == expected && MpProduct::product(values, MpProductOrder::HUFFMAN) == expected &&
+        MpProduct::product(std::vector<int>{}) == MpInt<4>(1LL) && MpProduct::product<8>(std::vector<int>{5, 0}) ==
+                                                                    MpInt<4>(0LL)) {
+        success++;
+        std::cout << printRight("Test OK") << std::endl;
+    } else {
+        failed++;
+        std::cout << printWrong("Test failed") << std::endl;
+    }
+}
+
+void testPrime(std::size_t &success, std::size_t &failed) {
+    std::cout << std::endl;
+    std::cout << printInfo("Prime testing") << std::endl;
+    // composites are Carmichael number and strong pseudoprimes to base 2 (the last two also to bases up to 23
+    // and 37)
+    auto ok = MpPrime::isProbablePrime(MpInt<MP_INT_UNLIMITED>::fromHex("7fffffffffffffffffffffffffffffff")) &&
+              MpPrime::isProbablePrime(MpInt<8>(65537LL)) && !MpPrime::isProbablePrime(MpInt<8>(-7LL)) &&
+              !MpPrime::isProbablePrime(MpInt<8>(1LL)) && !MpPrime::isProbablePrime(MpInt<8>(561LL)) &&
+              !MpPrime::isProbablePrime(MpInt<8>(3215031751LL)) &&
+              !MpPrime::isProbablePrime(MpInt<8>(3825123056546413051LL)) &&
+              !MpPrime::isProbablePrime(MpInt<MP_INT_UNLIMITED>::fromDecimal("318665857834031151167461"));
+    ok = ok && MpPrime::nextPrime(MpInt<MP_INT_UNLIMITED>::fromHex("10000000000000000")) ==
+               MpInt<MP_INT_UNLIMITED>::fromHex("1000000000000000d") &&
+         MpPrime::nextPrime(MpInt<8>(-5LL)) == MpInt<8>(2LL) &&
+         MpPrime::nextPrime(MpInt<8>(65521LL)) == MpInt<8>(65537LL);
+    try {
+        [[maybe_unused]] auto prime = MpPrime::nextPrime(MpInt<8>(longLongMax));
+        ok = false;
+    } catch (MpIntException<MpInt<MP_INT_UNLIMITED>> &e) {
+        ok = ok && e.overflow == MpInt<MP_INT_UNLIMITED>::fromDecimal("9223372036854775837");
+    }
+    if (ok) {
+        success++;
+        std::cout << printRight("Test OK") << std::endl;
+    } else {
+        failed++;
+        std::cout << printWrong("Test failed") << std::endl;
+    }
+}
+
+void testRandom(std::size_t &success, std::size_t &failed) {
+    std::cout << std::endl;
+    std::cout << printInfo("Random number testing") << std::endl;
+    MpRandom engine(42);
+    auto limit = MpInt<MP_INT_UNLIMITED>::fromHex("10000000000000000000000000");
+    auto half = MpInt<MP_INT_UNLIMITED>::fromHex("8000000000000000000000000");
+    auto ok = MpInt<MP_INT_UNLIMITED>::random(0, engine) == MpInt<4>(0LL);
+    auto upperHalf = false;
+    for (int i = 0; i < 1000; i++) {
+        auto value = MpInt<MP_INT_UNLIMITED>::random(100, engine);
+        ok = ok && !value.isNegative() && value < limit;
+        upperHalf = upperHalf || value >= half;
+        [[maybe_unused]] auto bounded = MpInt<8>::random(63, engine);
+    }
+    std::array<bool, 10> seen{};
+    for (int i = 0; i < 1000; i++) {
+        auto value = MpInt<8>::randomBelow(MpInt<8>(10LL), engine);
+        ok = ok && !value.isNegative() && value < MpInt<8>(10LL);
+        seen[std::stoul(value.toDecimal())] = true;
+    }
+    // identities on large random operands
+    for (int i = 0; i < 200; i++) {
+        auto a = MpInt<MP_INT_UNLIMITED>::random(2000, engine);
+        auto b = MpInt<MP_INT_UNLIMITED>::randomBelow(a, engine) + MpInt<4>(1LL);
+        ok = ok && (a * b) / b == a && (a + b) - b == a;
+    }
+    try {
+        [[maybe_unused]] auto value = MpInt<MP_INT_UNLIMITED>::randomBelow(MpInt<MP_INT_UNLIMITED>(0LL), engine);
+        ok = false;
+    } catch (std::invalid_argument &) {
+    }
+    if (ok && upperHalf && std::all_of(seen.begin(), seen.end(), [](bool value) { return value; })) {
+        success++;
+        std::cout << printRight("Test OK") << std::endl;
+    } else {
+        failed++;
+        std::cout << printWrong("Test failed") << std::endl;
+    }
+}
+
+void testCombinatorics(std::size_t &success, std::size_t &failed) {
+    std::cout << std::endl;
+    std::cout << printInfo("Combinatorics testing") << std::endl;
+    using Unlimited = MpInt<MP_INT_UNLIMITED>;
+    auto ok = MpCombinatorics::fib(MpInt<8>(0LL)) == MpInt<8>(0LL) &&
+              MpCombinatorics::fib(MpInt<8>(1LL)) == MpInt<8>(1LL) &&
+              MpCombinatorics::fib(MpInt<8>(10LL)) == MpInt<8>(55LL) &&
+              MpCombinatorics::fib(MpInt<8>(-10LL)) == MpInt<8>(-55LL) &&
+              MpCombinatorics::fib(MpInt<8>(-9LL)) == MpInt<8>(34LL) &&
+              MpCombinatorics::fib(MpInt<8>(92LL)) == MpInt<8>(7540113804746346429LL) &&
+              MpCombinatorics::fib(Unlimited(100LL)) == Unlimited::fromDecimal("354224848179261915075");
+    // F(n + 1) F(n - 1) - F(n)^2 = (-1)^n
+    auto index = Unlimited(1000LL);
+    auto fib = MpCombinatorics::fib(index);
+    ok = ok && MpCombinatorics::fib(index + Unlimited(1LL)) * MpCombinatorics::fib(index - Unlimited(1LL)) -
+               fib * fib == Unlimited(1LL);
+    // both binomial algorithms against factorials, zero outside of 0 <= k <= n
+    auto factorial = [](long long n) { return Unlimited(n).factorial(); };
+    ok = ok && MpCombinatorics::binomial(MpInt<8>(10LL), MpInt<8>(3LL)) == MpInt<8>(120LL) &&
+         MpCombinatorics::binomial(MpInt<8>(10LL), MpInt<8>(11LL)) == MpInt<8>(0LL) &&
+         MpCombinatorics::binomial(MpInt<8>(10LL), MpInt<8>(-1LL)) == MpInt<8>(0LL) &&
+         MpCombinatorics::binomial(Unlimited(1000LL), Unlimited(500LL)) ==
+         factorial(1000) / (factorial(500) * factorial(500)) &&
+         MpCombinatorics::binomial(Unlimited(1000LL), Unlimited(997LL)) == Unlimited(166167000LL) &&
+         MpCombinatorics::binomial(Unlimited::fromHex("100000000000000000"), Unlimited(2LL)) ==
+         Unlimited::fromHex("7ffffffffffffffff80000000000000000");
+    ok = ok && MpCombinatorics::multifactorial(MpInt<8>(10LL), MpInt<8>(3LL)) == MpInt<8>(280LL) &&
+         MpCombinatorics::multifactorial(MpInt<8>(9LL), MpInt<8>(2LL)) == MpInt<8>(945LL) &&
+         MpCombinatorics::multifactorial(MpInt<8>(5LL), MpInt<8>(7LL)) == MpInt<8>(5LL) &&
+         MpCombinatorics::multifactorial(MpInt<8>(-5LL), MpInt<8>(2LL)) == MpInt<8>(1LL) &&
+         MpCombinatorics::multifactorial(Unlimited(300LL), Unlimited(1LL)) == factorial(300);
+    try {
+        [[maybe_unused]] auto value = MpCombinatorics::fib(MpInt<8>(93LL));
+        ok = false;
+    } catch (MpIntException<MpInt<MP_INT_UNLIMITED>> &e) {
+        ok = ok && e.overflow == Unlimited::fromDecimal("12200160415121876738");
+    }
+    try {
+        [[maybe_unused]] auto value = MpCombinatorics::multifactorial(MpInt<8>(5LL), MpInt<8>(0LL));
+        ok = false;
+    } catch (std::invalid_argument &) {
+    }
+    if (ok) {
+        success++;
+        std::cout << printRight("Test OK") << std::endl;
+    } else {
+        failed++;
+        std::cout << printWrong("Test failed") << std::endl;
+    }
+}
+
+void testConstants(std::size_t &success, std::size_t &failed) {
+    std::cout << std::endl;
+    std::cout << printInfo("Constants testing") << std::endl;
+    using Unlimited = MpInt<MP_INT_UNLIMITED>;
+    auto ok = MpConstants::toDecimal("pi", 50) == "3.14159265358979323846264338327950288419716939937510" &&
+              MpConstants::toDecimal("e", 50) == "2.71828182845904523536028747135266249775724709369995" &&
+              MpConstants::toDecimal("ln2", 50) == "0.69314718055994530941723212145817656807550013436025" &&
+              MpConstants::toDecimal("pi", 0) == "3" && MpConstants::toDecimal("ln2", 1) == "0.6";
+    // sum of 2^-n for n < 10 is (2^10 - 1) / 2^9
+    auto [t, q] = MpSeries::sum([](std::uint64_t n) {
+        return MpSeriesTerm{Unlimited(1LL), Unlimited(1LL), Unlimited(n == 0 ? 1LL : 2LL)};
+    }, 10);
+    ok = ok && t * Unlimited(512LL) == q * Unlimited(1023LL);
+    for (long long i = 0; i < 1000; i++) {
+        auto root = Unlimited(i).sqrt();
+        ok = ok && root * root <= Unlimited(i) && (root + Unlimited(1LL)) * (root + Unlimited(1LL)) > Unlimited(i);
+    }
+    auto power = MpInt<MP_INT_UNLIMITED>::fromHex("1000000000000000000000000000000000000000000000000");
+    ok = ok && (power * power).sqrt() == power && (power * power - Unlimited(1LL)).sqrt() == power - Unlimited(1LL);
+    try {
+        [[maybe_unused]] auto root = MpInt<8>(-4LL).sqrt();
+        ok = false;
+    } catch (std::invalid_argument &) {
+    }
+    if (ok) {
+        success++;
+        std::cout << printRight("Test OK") << std::endl;
+    } else {
+        failed++;
+        std::cout << printWrong("Test failed") << std::endl;
+    }
+}
+
+void testDecimal(std::size_t &success, std::size_t &failed) {
+    std::cout << std::endl;
+    std::cout << printInfo("Decimal testing") << std::endl;
+    using Money = MpDecimal<MP_INT_UNLIMITED, 2>;
+    using Precise = MpDecimal<MP_INT_UNLIMITED, 30>;
+    auto ok = Money::fromString("12.345").toString() == "12.34" && Money::fromString("12.355").toString() == "12.36" &&
+              Money::fromString("-0.005", MpRoundingMode::HALF_UP).toString() == "-0.01" &&
+              Money::fromString("-0.0051", MpRoundingMode::HALF_DOWN).toString() == "-0.01" &&
+              Money::fromString("-0.005", MpRoundingMode::HALF_DOWN).toString() == "0.00" &&
+              Money::fromString("-0.001", MpRoundingMode::FLOOR).toString() == "-0.01" &&
+              Money::fromString("-0.009", MpRoundingMode::CEILING).toString() == "0.00" &&
+              Money::fromString("0.001", MpRoundingMode::UP).toString() == "0.01" &&
+              Money::fromString("0.009", MpRoundingMode::DOWN).toString() == "0.00" &&
+              Money::fromString("+.5").toString() == "0.50" &&
+              Money(MpInt<MP_INT_UNLIMITED>(-42LL)).toString() == "-42.00";
+    ok = ok && (Money::fromString("1.10") * Money::fromString("1.10")).toString() == "1.21" &&
+         (Money::fromString("0.05") * Money::fromString("0.15")).toString() == "0.01" &&
+         (Money::fromString("1.01") - Money::fromString("2.02")).toString() == "-1.01" &&
+         (-Money::fromString("3")).toString() == "-3.00" && Money::fromString("1.5") < Money::fromString("1.51") &&
+         (MpDecimal<8, 4>::fromString("2") / MpDecimal<8, 4>::fromString("-3")).toString() == "-0.6667" &&
+         MpDecimal<8, 4>::divide(MpDecimal<8, 4>::fromString("2"), MpDecimal<8, 4>::fromString("-3"),
+                                 MpRoundingMode::FLOOR).toString() == "-0.6667" &&
+         (Precise::fromString("1") / Precise::fromString("7")).toString() == "0.142857142857142857142857142857" &&
+         (Precise::fromString("1.5") * Precise::fromString("-1.5")).toString() == "-2.250000000000000000000000000000";
+    ok = ok && Money::fromString("2.50").rescale<0>().toString() == "2" &&
+         Money::fromString("3.50").rescale<0>().toString() == "4" &&
+         Precise::fromString("0.000000000000000000000000500001").rescale<6>().toString() == "0.000000" &&
+         Precise::fromString("1.000000000000000000000000500001").rescale<5>(MpRoundingMode::UP).toString() ==
+         "1.00001" &&
+         Money::fromString("1.25").rescale<25>() == MpDecimal<MP_INT_UNLIMITED, 25>::fromString("1.25");
+    try {
+        [[maybe_unused]] auto value =
+                MpDecimal<8, 2>::fromString("90000000000000000") * MpDecimal<8, 2>::fromString("10");
+        ok = false;
+    } catch (MpIntException<MpInt<MP_INT_UNLIMITED>> &e) {
+        ok = ok && e.overflow == MpInt<MP_INT_UNLIMITED>::fromDecimal("90000000000000000000");
+    }
+    try {
+        [[maybe_unused]] auto value = Money::fromString("1.2.3");
+        ok = false;
+    } catch (std::invalid_argument &) {
+    }
+    if (ok) {
+        success++;
+        std::cout << printRight("Test OK") << std::endl;
+    } else {
+        failed++;
+        std::cout << printWrong("Test failed") << std::endl;
+    }
+}
+
+void testRns(std::size_t &success, std::size_t &failed) {
+    std::cout << std::endl;
+    std::cout << printInfo("Residue number system testing") << std::endl;
+    typedef MpInt<MP_INT_UNLIMITED> Unlimited;
+    auto basis = MpRns::makeBasis(1000);
+    // Horner evaluation of polynomial with large coefficients at negative point, every product has 900 bits
+    auto point = Unlimited::fromHex("-123456789abcdef0123456789abcdef");
+    Unlimited expected;
+    MpRns value(basis), rnsPoint(point, basis);
+    MpRandom engine(50);
+    for (int i = 0; i < 7; i++) {
+        auto coefficient = Unlimited::random(100, engine) - Unlimited::random(100, engine);
+        expected = expected * point + coefficient;
+        value = value * rnsPoint + MpRns(coefficient, basis);
+    }
+    auto limit = Unlimited::fromHex("1" + std::string(250, '0')) - Unlimited(1LL);
+    auto ok = value.toInt() == expected && MpRns(limit, basis).toInt() == limit &&
+              MpRns(Unlimited(0LL) - limit, basis).toInt() == Unlimited(0LL) - limit &&
+              (-MpRns(limit, basis) - MpRns(Unlimited(1LL), basis)).toInt() ==
+              Unlimited(0LL) - limit - Unlimited(1LL) &&
+              MpRns(Unlimited(-5LL), basis) == MpRns(Unlimited(-5LL), basis) && MpRns(basis).toInt() == Unlimited() &&
+              MpRns(MpInt<8>(longLongMin), basis).toInt<8>() == MpInt<8>(longLongMin);
+    const auto &moduli = basis->getModuli();
+    for (std::size_t i = 0; i < moduli.size(); i++) {
+        ok = ok && moduli[i] > (std::uint64_t{1} << 63) && (i == 0 || moduli[i] < moduli[i - 1]) &&
+             MpPrime::isProbablePrime(Unlimited(static_cast<long long>(moduli[i] >> 1)) * Unlimited(2LL) +
+                                      Unlimited(1LL));
+    }
+    try {
+        [[maybe_unused]] auto result = MpRns(limit, basis).toInt<8>();
+        ok = false;
+    } catch (MpIntException<MpInt<MP_INT_UNLIMITED>> &e) {
+        ok = ok && e.overflow == limit;
+    }
+    try {
+        [[maybe_unused]] auto result = value + MpRns(MpRns::makeBasis(1000));
+        ok = false;
+    } catch (std::invalid_argument &) {
+    }
+    if (ok) {
+        success++;
+        std::cout << printRight("Test OK") << std::endl;
+    } else {
+        failed++;
+        std::cout << printWrong("Test failed") << std::endl;
+    }
+}
+
 void test() {
     std::size_t testSuccess = 0;
     std::size_t testFailed = 0;
 
     testOverflow(testSuccess, testFailed);
+    testPredictedOverflow(testSuccess, testFailed);
     testRandomInts(testSuccess, testFailed);
     testFactorial(testSuccess, testFailed);
+    testOutput(testSuccess, testFailed);
+    testRadix(testSuccess, testFailed);
+    testDecimalParsing(testSuccess, testFailed);
+    testParser(testSuccess, testFailed);
+    testBatch(testSuccess, testFailed);
+    testCache(testSuccess, testFailed);
+    testRingBuffer(testSuccess, testFailed);
+    testCancellation(testSuccess, testFailed);
+    testComparison(testSuccess, testFailed);
+    testMixedPrecision(testSuccess, testFailed);
+    testAccumulator(testSuccess, testFailed);
+    testProduct(testSuccess, testFailed);
+    testPrime(testSuccess, testFailed);
+    testRandom(testSuccess, testFailed);
+    testCombinatorics(testSuccess, testFailed);
+    testConstants(testSuccess, testFailed);
+    testDecimal(testSuccess, testFailed);
+    testRns(testSuccess, testFailed);
 
     std::cout << std::endl;
     std::cout << printInfo("Total tests: ") << (testSuccess + testFailed) << std::endl;
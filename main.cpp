@@ -1,21 +1,81 @@
+#include <charconv>
+#include <chrono>
 #include <iostream>
+#include <fstream>
 #include "Test.h"
+#include "MpConstants.h"
 #include "MpTerm.h"
 
 void printHelp() {
     std::cout << "1 - Start konzole s neomezenou presnosti cisla." << std::endl;
     std::cout << "2 - Start konzole s omezenou presnosti cisla na 32-bitu." << std::endl;
     std::cout << "3 - Showcase vyuziti knihovny pro praci s neomezenymy cisly." << std::endl;
+    std::cout << "4 [soubor] - Davkovy vypocet s neomezenou presnosti cisla (ze souboru nebo standardniho vstupu)."
+              << std::endl;
+    std::cout << "5 [soubor] - Davkovy vypocet s omezenou presnosti cisla na 32-bitu." << std::endl;
+    std::cout << "6 <pi|e|ln2> <cislice> - Vypocet konstanty na dany pocet desetinnych mist (doba vypoctu na"
+                 " chybovy vystup)." << std::endl;
 }
 
+/**
+ * @brief Run batch evaluation of file (or standard input if file is not given) on all hardware threads.
+ * @tparam bytePrecision Maximal precision of number in bytes (0 is unlimited).
+ */
+template<std::size_t bytePrecision>
+int runBatch(int argc, char **argv) {
+    const std::size_t threads = std::max(1U, std::thread::hardware_concurrency());
+    std::ios::sync_with_stdio(false);
+    std::cin.tie(nullptr);
+    if (argc == 3) {
+        std::ifstream file(argv[2]);
+        if (!file) {
+            std::cerr << "Soubor " << argv[2] << " nelze otevrit." << std::endl;
+            return EXIT_FAILURE;
+        }
+        MpTerm<bytePrecision>().runBatch(file, std::cout, threads);
+    } else {
+        MpTerm<bytePrecision>().runBatch(std::cin, std::cout, threads);
+    }
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @brief Print constant to given count of digits and report time of computation (end-to-end benchmark of
+ * multiplication, division and decimal output).
+ */
+int runConstant(char **argv) {
+    std::string_view name(argv[2]);
+    std::string_view text(argv[3]);
+    std::size_t digits = 0;
+    auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), digits);
+    if (error != std::errc() || end != text.data() + text.size() || (name != "pi" && name != "e" && name != "ln2")) {
+        printHelp();
+        return EXIT_FAILURE;
+    }
+    auto start = std::chrono::steady_clock::now();
+    auto constant = MpConstants::toDecimal(name, digits);
+    auto computed = std::chrono::steady_clock::now();
+    std::cout << constant << std::endl;
+    std::cerr << "Vypocet trval " << std::chrono::duration<double>(computed - start).count() << " s." << std::endl;
+    return EXIT_SUCCESS;
+}
 
 int main(int argc, char **argv) {
-    if (argc != 2) {
-        std::cout << "Program potrebuje prave jeden argument [1|2|3]." << std::endl;
+    if (argc < 2 || argc > 4) {
+        std::cout << "Program potrebuje jeden argument [1|2|3|4|5|6], u 4 a 5 volitelne soubor, u 6 konstantu"
+                     " a pocet cislic." << std::endl;
         printHelp();
         return EXIT_FAILURE;
     }
+    if (!MpStorage::configureFromEnvironment()) {
+        std::cerr << "Neplatna hodnota MPINT_MAP_THRESHOLD, mapovani zustava vypnute." << std::endl;
+    }
+    MpStats::dumpAtExit();
     std::string argument(argv[1]);
+    if ((argc == 3 && argument != "4" && argument != "5") || (argc == 4) != (argument == "6")) {
+        printHelp();
+        return EXIT_FAILURE;
+    }
     if (argument == "1") {
         MpTerm<MP_INT_UNLIMITED>().run();
         return EXIT_SUCCESS;
@@ -25,6 +85,12 @@ int main(int argc, char **argv) {
     } else if (argument == "3") {
         test();
         return EXIT_SUCCESS;
+    } else if (argument == "4") {
+        return runBatch<MP_INT_UNLIMITED>(argc, argv);
+    } else if (argument == "5") {
+        return runBatch<4>(argc, argv);
+    } else if (argument == "6") {
+        return runConstant(argv);
     } else {
         printHelp();
         return EXIT_FAILURE;